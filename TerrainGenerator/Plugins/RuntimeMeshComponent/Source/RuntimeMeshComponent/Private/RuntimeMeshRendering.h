@@ -232,6 +232,13 @@ public:
 	virtual void Bind(FLocalVertexFactory::FDataType& DataType) override
 	{
 #if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 19
+		// Sections without colors read white from the engine null buffer
+		if (NumVertices == 0)
+		{
+			DataType.ColorComponent = FVertexStreamComponent(&GNullColorVertexBuffer, 0, 0, EVertexElementType::VET_Color, EVertexStreamUsage::ManualFetch);
+			DataType.ColorComponentsSRV = GNullColorVertexBuffer.VertexBufferSRV;
+			return;
+		}
 		DataType.ColorComponent = FVertexStreamComponent(this, 0, 4, EVertexElementType::VET_Color, EVertexStreamUsage::ManualFetch);
 		DataType.ColorComponentsSRV = ShaderResourceView;
 #else
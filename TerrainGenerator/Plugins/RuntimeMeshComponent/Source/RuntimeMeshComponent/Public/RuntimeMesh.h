@@ -319,7 +319,7 @@ public:
 	}
 
 	template<typename IndexType>
-	FORCEINLINE void UpdateMeshSectionTriangles(int32 SectionId, TArray<IndexType>& InTriangles, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
+	FORCEINLINE void UpdateMeshSectionTriangles(int32 SectionId, const TArray<IndexType>& InTriangles, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
 		check(IsInGameThread());
 		GetRuntimeMeshData()->UpdateMeshSectionTriangles<IndexType>(SectionId, InTriangles, UpdateFlags);
@@ -0,0 +1,427 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#include "TG_NoiseGraph.h"
+#include "Hash/CityHash.h"
+
+// Registers of the sample position, relative to the origin of the row
+static const uint16 PositionX = 0;
+static const uint16 PositionY = 1;
+
+static bool IsSource(NoiseNodeType type)
+{
+  return type <= NoiseNodeType::NoiseNode_Constant;
+}
+
+static bool UsesNoise(NoiseNodeType type)
+{
+  return type < NoiseNodeType::NoiseNode_Constant;
+}
+
+// Value inputs (A, B, C) every type needs
+static int32 NumInputs(NoiseNodeType type)
+{
+  switch (type) {
+    case NoiseNodeType::NoiseNode_DomainWarp:
+    case NoiseNodeType::NoiseNode_Add:
+    case NoiseNodeType::NoiseNode_Multiply:
+      return 2;
+    case NoiseNodeType::NoiseNode_Select:
+      return 3;
+    case NoiseNodeType::NoiseNode_ScaleBias:
+    case NoiseNodeType::NoiseNode_Clamp:
+    case NoiseNodeType::NoiseNode_Curve:
+    case NoiseNodeType::NoiseNode_Terrace:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+FTG_NoiseProgramPtr FTG_NoiseProgram::Compile(const FNoiseGraph& graph, int32 seed, FString& error)
+{
+  const TArray<FNoiseGraphNode>& nodes = graph.nodes;
+  if (nodes.Num() == 0) {
+    error = TEXT("The graph has no nodes");
+    return nullptr;
+  }
+
+  int32 output = graph.output >= 0 ? graph.output : nodes.Num() - 1;
+  if (output >= nodes.Num() || nodes[output].type == NoiseNodeType::NoiseNode_DomainWarp) {
+    error = FString::Printf(TEXT("The output %d is not a value node"), output);
+    return nullptr;
+  }
+
+  // Inputs of every node, -1 when not used
+  TArray<FIntVector> inputs;
+  inputs.SetNum(nodes.Num());
+  for (int32 i = 0; i < nodes.Num(); ++i) {
+    const FNoiseGraphNode& node = nodes[i];
+    int32 numInputs = NumInputs(node.type);
+    int32 values[3] = { node.inputA, node.inputB, node.inputC };
+
+    for (int32 input = 0; input < 3; ++input) {
+      if (input >= numInputs) {
+        values[input] = -1;
+        continue;
+      }
+      // Only earlier nodes, so the graph has no cycles and the order of the nodes is the order of the tape
+      if (values[input] < 0 || values[input] >= i) {
+        error = FString::Printf(TEXT("Node %d: input %c must be an earlier node"), i, TEXT('A') + input);
+        return nullptr;
+      }
+      if (nodes[values[input]].type == NoiseNodeType::NoiseNode_DomainWarp) {
+        error = FString::Printf(TEXT("Node %d: input %c is a Domain Warp, it can only be used as coords"), i, TEXT('A') + input);
+        return nullptr;
+      }
+    }
+    inputs[i] = FIntVector(values[0], values[1], values[2]);
+
+    if (node.coords >= 0 && (node.coords >= i || nodes[node.coords].type != NoiseNodeType::NoiseNode_DomainWarp)) {
+      error = FString::Printf(TEXT("Node %d: coords must be an earlier Domain Warp"), i);
+      return nullptr;
+    }
+    if (node.type == NoiseNodeType::NoiseNode_Curve && node.curvePoints.Num() < 2) {
+      error = FString::Printf(TEXT("Node %d: the Curve needs at least 2 points"), i);
+      return nullptr;
+    }
+  }
+
+  // Only the nodes reaching the output, and the last node reading each one
+  TArray<bool> used;
+  used.Init(false, nodes.Num());
+  TArray<int32> lastUse;
+  lastUse.Init(-1, nodes.Num());
+  used[output] = true;
+  lastUse[output] = output;
+  for (int32 i = output; i >= 0; --i) {
+    if (!used[i]) {
+      continue;
+    }
+    int32 reads[4] = { inputs[i].X, inputs[i].Y, inputs[i].Z, nodes[i].coords };
+    for (int32 read : reads) {
+      if (read >= 0) {
+        used[read] = true;
+        lastUse[read] = FMath::Max(lastUse[read], i);
+      }
+    }
+  }
+
+  FTG_NoiseProgram* program = new FTG_NoiseProgram();
+  TArray<uint16> freeRegisters;
+  uint16 nextRegister = PositionY + 1;
+  auto Allocate = [&freeRegisters, &nextRegister]() -> uint16 {
+    return freeRegisters.Num() > 0 ? freeRegisters.Pop(false) : nextRegister++;
+  };
+
+  TArray<uint16> registerX;
+  TArray<uint16> registerY;
+  registerX.Init(PositionX, nodes.Num());
+  registerY.Init(PositionY, nodes.Num());
+
+  // Every seed offset gets its own permutation
+  TMap<int32, uint16> noiseForOffset;
+
+  for (int32 i = 0; i <= output; ++i) {
+    if (!used[i]) {
+      continue;
+    }
+    const FNoiseGraphNode& node = nodes[i];
+
+    FTG_NoiseInstruction instruction;
+    FMemory::Memzero(instruction);
+    instruction.Op = node.type;
+    instruction.A = inputs[i].X >= 0 ? registerX[inputs[i].X] : 0;
+    instruction.B = inputs[i].Y >= 0 ? registerX[inputs[i].Y] : 0;
+    instruction.C = inputs[i].Z >= 0 ? registerX[inputs[i].Z] : 0;
+    instruction.CoordX = node.coords >= 0 ? registerX[node.coords] : PositionX;
+    instruction.CoordY = node.coords >= 0 ? registerY[node.coords] : PositionY;
+    instruction.Octaves = FMath::Max(node.octaves, 1);
+    instruction.Frequency = node.frequency;
+    instruction.Lacunarity = node.lacunarity;
+    instruction.Gain = node.gain;
+
+    if (UsesNoise(node.type)) {
+      uint16* noise = noiseForOffset.Find(node.seedOffset);
+      if (!noise) {
+        TG_PerlinNoise<float>& newNoise = program->Noises[program->Noises.AddDefaulted()];
+        newNoise.setNoiseSeed(seed + node.seedOffset);
+        noise = &noiseForOffset.Add(node.seedOffset, (uint16)(program->Noises.Num() - 1));
+      }
+      instruction.Noise = *noise;
+    }
+
+    switch (node.type) {
+      case NoiseNodeType::NoiseNode_Constant:
+        instruction.Params[0] = node.bias;
+        break;
+      case NoiseNodeType::NoiseNode_DomainWarp:
+      case NoiseNodeType::NoiseNode_ScaleBias:
+        instruction.Params[0] = node.scale;
+        instruction.Params[1] = node.bias;
+        break;
+      case NoiseNodeType::NoiseNode_Clamp:
+        instruction.Params[0] = FMath::Min(node.minValue, node.maxValue);
+        instruction.Params[1] = FMath::Max(node.minValue, node.maxValue);
+        break;
+      case NoiseNodeType::NoiseNode_Select:
+        instruction.Params[0] = node.threshold;
+        instruction.Params[1] = FMath::Max(node.falloff, 0.f);
+        break;
+      case NoiseNodeType::NoiseNode_Terrace:
+        instruction.Params[0] = (float)FMath::Max(node.steps, 1);
+        instruction.Params[1] = FMath::Clamp(node.smoothness, 0.f, 1.f);
+        break;
+      case NoiseNodeType::NoiseNode_Curve: {
+        TArray<FVector2D> points = node.curvePoints;
+        points.Sort([](const FVector2D& A, const FVector2D& B) { return A.X < B.X; });
+        instruction.CurveStart = program->CurvePoints.Num();
+        instruction.CurveCount = points.Num();
+        program->CurvePoints.Append(points);
+        break;
+      }
+      default:
+        break;
+    }
+
+    // The outputs never alias the inputs, the registers of this node are freed after it
+    instruction.OutX = registerX[i] = Allocate();
+    if (node.type == NoiseNodeType::NoiseNode_DomainWarp) {
+      instruction.OutY = registerY[i] = Allocate();
+    }
+
+    TArray<int32, TInlineAllocator<4>> lastReads;
+    for (int32 read : { inputs[i].X, inputs[i].Y, inputs[i].Z, node.coords }) {
+      if (read >= 0 && lastUse[read] == i) {
+        lastReads.AddUnique(read);
+      }
+    }
+    for (int32 read : lastReads) {
+      freeRegisters.Push(registerX[read]);
+      if (nodes[read].type == NoiseNodeType::NoiseNode_DomainWarp) {
+        freeRegisters.Push(registerY[read]);
+      }
+    }
+
+    program->Tape.Add(instruction);
+  }
+
+  program->Registers = nextRegister;
+  program->Output = registerX[output];
+  return MakeShareable(program);
+}
+
+void FTG_NoiseProgram::EvaluateGrid(double originX, double originY, double step, int32 width, int32 height, float* out) const
+{
+  // One row of samples per register. A single sample (Evaluate) of up to 64 registers stays on the
+  // stack, a grid allocates once for all its rows
+  TArray<float, TInlineAllocator<64>> registers;
+  registers.SetNumUninitialized(Registers * width);
+
+  for (int32 row = 0; row < height; ++row) {
+    EvaluateRow(originX, originY + row * step, step, width, registers.GetData());
+    FMemory::Memcpy(out + row * width, &registers[Output * width], width * sizeof(float));
+  }
+}
+
+float FTG_NoiseProgram::Evaluate(double x, double y) const
+{
+  float value = 0.f;
+  EvaluateGrid(x, y, 0.0, 1, 1, &value);
+  return value;
+}
+
+void FTG_NoiseProgram::EvaluateRow(double originX, double y, double step, int32 width, float* registers) const
+{
+  float* positionX = registers + PositionX * width;
+  float* positionY = registers + PositionY * width;
+  for (int32 i = 0; i < width; ++i) {
+    positionX[i] = (float)(i * step);
+    positionY[i] = 0.f;
+  }
+
+  for (const FTG_NoiseInstruction& instruction : Tape) {
+    float* out = registers + instruction.OutX * width;
+    const float* a = registers + instruction.A * width;
+    const float* b = registers + instruction.B * width;
+    const float* c = registers + instruction.C * width;
+
+    if (IsSource(instruction.Op)) {
+      EvaluateSource(instruction, originX, y, step, width, registers, out);
+      continue;
+    }
+
+    switch (instruction.Op) {
+      case NoiseNodeType::NoiseNode_DomainWarp: {
+        // Offsets stay relative to the origin of the row
+        const float* coordX = registers + instruction.CoordX * width;
+        const float* coordY = registers + instruction.CoordY * width;
+        float* outY = registers + instruction.OutY * width;
+        const float strength = instruction.Params[0];
+        for (int32 i = 0; i < width; ++i) {
+          out[i] = coordX[i] + a[i] * strength;
+          outY[i] = coordY[i] + b[i] * strength;
+        }
+        break;
+      }
+      case NoiseNodeType::NoiseNode_Add:
+        for (int32 i = 0; i < width; ++i) {
+          out[i] = a[i] + b[i];
+        }
+        break;
+      case NoiseNodeType::NoiseNode_Multiply:
+        for (int32 i = 0; i < width; ++i) {
+          out[i] = a[i] * b[i];
+        }
+        break;
+      case NoiseNodeType::NoiseNode_ScaleBias:
+        for (int32 i = 0; i < width; ++i) {
+          out[i] = a[i] * instruction.Params[0] + instruction.Params[1];
+        }
+        break;
+      case NoiseNodeType::NoiseNode_Select: {
+        const float threshold = instruction.Params[0];
+        const float falloff = instruction.Params[1];
+        for (int32 i = 0; i < width; ++i) {
+          if (falloff > 0.f) {
+            const float alpha = FMath::SmoothStep(threshold - falloff, threshold + falloff, c[i]);
+            out[i] = FMath::Lerp(a[i], b[i], alpha);
+          }
+          else {
+            out[i] = c[i] < threshold ? a[i] : b[i];
+          }
+        }
+        break;
+      }
+      case NoiseNodeType::NoiseNode_Clamp:
+        for (int32 i = 0; i < width; ++i) {
+          out[i] = FMath::Clamp(a[i], instruction.Params[0], instruction.Params[1]);
+        }
+        break;
+      case NoiseNodeType::NoiseNode_Curve: {
+        const FVector2D* points = &CurvePoints[instruction.CurveStart];
+        const int32 last = instruction.CurveCount - 1;
+        for (int32 i = 0; i < width; ++i) {
+          const float value = a[i];
+          if (value <= points[0].X) {
+            out[i] = points[0].Y;
+            continue;
+          }
+          if (value >= points[last].X) {
+            out[i] = points[last].Y;
+            continue;
+          }
+          int32 segment = 1;
+          while (points[segment].X < value) {
+            ++segment;
+          }
+          const FVector2D& p0 = points[segment - 1];
+          const FVector2D& p1 = points[segment];
+          const float span = p1.X - p0.X;
+          out[i] = span > 0.f ? FMath::Lerp(p0.Y, p1.Y, (value - p0.X) / span) : p1.Y;
+        }
+        break;
+      }
+      case NoiseNodeType::NoiseNode_Terrace: {
+        const float steps = instruction.Params[0];
+        const float smoothness = instruction.Params[1];
+        for (int32 i = 0; i < width; ++i) {
+          const float level = a[i] * steps;
+          const float floorLevel = FMath::FloorToFloat(level);
+          const float ramp = FMath::SmoothStep(1.f - smoothness, 1.f, level - floorLevel);
+          out[i] = (floorLevel + ramp) / steps;
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+void FTG_NoiseProgram::EvaluateSource(const FTG_NoiseInstruction& instruction, double originX, double originY, double step,
+  int32 width, const float* registers, float* out) const
+{
+  if (instruction.Op == NoiseNodeType::NoiseNode_Constant) {
+    for (int32 i = 0; i < width; ++i) {
+      out[i] = instruction.Params[0];
+    }
+    return;
+  }
+
+  const TG_PerlinNoise<float>& noise = Noises[instruction.Noise];
+  const double frequency = instruction.Frequency;
+
+  // Unwarped octaveNoise: the batched kernel of the default terrain
+  if (instruction.Op == NoiseNodeType::NoiseNode_Perlin && instruction.CoordX == PositionX && instruction.CoordY == PositionY
+    && instruction.Lacunarity == 2.f && instruction.Gain == 0.5f) {
+    noise.FillHeightGrid(originX * frequency, originY * frequency, step * frequency, width, 1, instruction.Octaves, out);
+    return;
+  }
+
+  const float* coordX = registers + instruction.CoordX * width;
+  const float* coordY = registers + instruction.CoordY * width;
+  for (int32 i = 0; i < width; ++i) {
+    double x = (originX + coordX[i]) * frequency;
+    double y = (originY + coordY[i]) * frequency;
+    // The positions stay in double, the noise splits them in lattice cell + float offset
+    float amp = 1.f;
+    float value = 0.f;
+    // Sum of the noise derivatives of the octaves so far (Eroded)
+    float slopeX = 0.f;
+    float slopeY = 0.f;
+
+    for (int32 octave = 0; octave < instruction.Octaves; ++octave) {
+      switch (instruction.Op) {
+        case NoiseNodeType::NoiseNode_Perlin:
+          value += noise.noise(x, y) * amp;
+          break;
+        case NoiseNodeType::NoiseNode_Simplex:
+          value += noise.simplexNoise(x, y) * amp;
+          break;
+        case NoiseNodeType::NoiseNode_Value:
+          value += noise.valueNoise(x, y) * amp;
+          break;
+        case NoiseNodeType::NoiseNode_Cellular:
+          value += noise.cellularNoise(x, y) * amp;
+          break;
+        case NoiseNodeType::NoiseNode_Ridged: {
+          const float ridge = 1.f - FMath::Abs(noise.noise(x, y));
+          value += ridge * ridge * amp;
+          break;
+        }
+        case NoiseNodeType::NoiseNode_Billow:
+          value += (2.f * FMath::Abs(noise.noise(x, y)) - 1.f) * amp;
+          break;
+        case NoiseNodeType::NoiseNode_Eroded: {
+          float dNdx, dNdy;
+          const float n = noise.noiseDerivatives(x, y, dNdx, dNdy);
+          slopeX += dNdx;
+          slopeY += dNdy;
+          value += n * amp / (1.f + slopeX * slopeX + slopeY * slopeY);
+          break;
+        }
+        default:
+          break;
+      }
+      x *= instruction.Lacunarity;
+      y *= instruction.Lacunarity;
+      amp *= instruction.Gain;
+    }
+
+    out[i] = value;
+  }
+}
+
+uint64 FTG_NoiseProgram::GetHash() const
+{
+  TArray<uint8> bytes;
+  bytes.Append((const uint8*)Tape.GetData(), Tape.Num() * sizeof(FTG_NoiseInstruction));
+  bytes.Append((const uint8*)CurvePoints.GetData(), CurvePoints.Num() * sizeof(FVector2D));
+  for (const TG_PerlinNoise<float>& noise : Noises) {
+    uint32 permutation = noise.GetPermutationHash();
+    bytes.Append((const uint8*)&permutation, sizeof(permutation));
+  }
+  bytes.Append((const uint8*)&Output, sizeof(Output));
+
+  return CityHash64((const char*)bytes.GetData(), bytes.Num());
+}
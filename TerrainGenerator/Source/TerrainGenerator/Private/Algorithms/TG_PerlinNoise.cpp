@@ -1,65 +1,108 @@
 // Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
 
 #include "TG_PerlinNoise.h"
+#include "HAL/IConsoleManager.h"
+#include <type_traits>
 
 #define FASTFLOOR(x) ( ((x)>0) ? ((int)x) : (((int)x)-1) )
 
-TG_PerlinNoise::TG_PerlinNoise()
+static TAutoConsoleVariable<int32> CVarNoiseVectorKernel(
+  TEXT("tg.Noise.VectorKernel"),
+  1,
+  TEXT("1 = evaluate height grids with the vector kernel, 0 = use the scalar reference path."));
+
+// Samples evaluated per chunk of a row (multiple of the 4 lanes of a VectorRegister)
+static const int32 NoiseChunkSize = 64;
+
+// Grad(hash, x, y, 0) written as GradientX[hash] * x + GradientY[hash] * y
+static const float GradientX[16] = { 1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, -1.f, 0.f };
+static const float GradientY[16] = { 1.f, 1.f, -1.f, -1.f, 0.f, 0.f, 0.f, 0.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f };
+
+// Lattice cell (wrapped to the period of the permutation) and offset inside it
+static FORCEINLINE int32 SplitCoord(double x, double& sub)
 {
+  const double cell = floor(x);
+  sub = x - cell;
+  return (int32)((int64)cell & 255);
 }
 
-void TG_PerlinNoise::setNoiseSeed(const int32& newSeed)
+static_assert(std::is_trivially_copyable<TG_PerlinNoise<float>>::value, "TG_PerlinNoise is copied by value into every FTG_GenerationParams");
+
+template <typename T>
+TG_PerlinNoise<T>::TG_PerlinNoise()
 {
-  // Set the Seed
-  FMath::RandInit(newSeed);
+  FMemory::Memzero(perm);
+}
 
-  // Fill the array with default values
-  perm.Init(0, 512);
+template <typename T>
+void TG_PerlinNoise<T>::setNoiseSeed(const int32& newSeed)
+{
+  // Own stream for the Seed, the global FMath::Rand of the game is not touched
+  FRandomStream stream(newSeed);
 
-  /* Shuffle the numbers */
-  TArray<bool> availableSeeds;
-  availableSeeds.Init(true, 256);
-  for (int i = 0; i < 256; ++i) {
-    // Generate one different number each time
-    uint8 nextNumber;
-    do {
-      nextNumber = FMath::RandRange(0, 255);
-    } while (!availableSeeds[nextNumber]);
+  // Every value once
+  for (int32 i = 0; i < 256; ++i) {
+    perm[i] = (uint8)i;
+  }
 
-    // Asign the number
-    perm[i] = nextNumber;
-    perm[i + 256] = nextNumber;
+  /* Shuffle the numbers (Fisher-Yates) */
+  for (int32 i = 255; i > 0; --i) {
+    const int32 j = stream.RandRange(0, i);
+    Swap(perm[i], perm[j]);
   }
 
+  // Second copy so the lookups never wrap
+  FMemory::Memcpy(perm + 256, perm, 256);
 }
 
-double TG_PerlinNoise::Fade(double t)
+template <typename T>
+T TG_PerlinNoise<T>::Fade(T t) const
 {
   return t * t * t * (t * (t * 6 - 15) + 10);
 }
 
-double TG_PerlinNoise::Lerp(double t, double a, double b)
+template <typename T>
+T TG_PerlinNoise<T>::FadeDerivative(T t) const
+{
+  // 30 * t^2 * (t - 1)^2
+  return 30 * t * t * (t * (t - 2) + 1);
+}
+
+template <typename T>
+T TG_PerlinNoise<T>::Lerp(T t, T a, T b) const
 {
   return a + t * (b - a);
 }
 
-double TG_PerlinNoise::Grad(int32 hash, double x, double y, double z)
+template <typename T>
+T TG_PerlinNoise<T>::Grad(int32 hash, T x, T y, T z) const
 {
   const int32 h = hash & 15;
-  const double u = h < 8 ? x : y;
-  const double v = h < 4 ? y : h == 12 || h == 14 ? x : z;
+  const T u = h < 8 ? x : y;
+  const T v = h < 4 ? y : h == 12 || h == 14 ? x : z;
   return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
 }
 
-double TG_PerlinNoise::noise(double x, double y, double z)
+template <typename T>
+uint32 TG_PerlinNoise<T>::GetPermutationHash() const {
+  return FCrc::MemCrc32(perm, sizeof(perm));
+}
+
+template <typename T>
+T TG_PerlinNoise<T>::noise(double x, double y, double z) const
+{
+  double sub_x, sub_y, sub_z;
+  const int32 unit_x = SplitCoord(x, sub_x),
+    unit_y = SplitCoord(y, sub_y),
+    unit_z = SplitCoord(z, sub_z);
+
+  return LatticeNoise(unit_x, unit_y, unit_z, (T)sub_x, (T)sub_y, (T)sub_z);
+}
+
+template <typename T>
+T TG_PerlinNoise<T>::LatticeNoise(int32 unit_x, int32 unit_y, int32 unit_z, T sub_x, T sub_y, T sub_z) const
 {
-  const auto unit_x = (int)floor(x) & 255,
-    unit_y = (int)floor(y) & 255,
-    unit_z = (int)floor(z) & 255;
-  const auto sub_x = x - floor(x),
-    sub_y = y - floor(y),
-    sub_z = z - floor(z);
-  const auto  u = Fade(sub_x),
+  const T u = Fade(sub_x),
     v = Fade(sub_y),
     w = Fade(sub_z);
   const auto a = perm[unit_x] + unit_y,
@@ -81,15 +124,17 @@ double TG_PerlinNoise::noise(double x, double y, double z)
         Grad( perm[bb + 1], sub_x - 1, sub_y - 1, sub_z - 1 ) ) ) );
 }
 
-double TG_PerlinNoise::noise0_1(double x, double y, double z)
+template <typename T>
+T TG_PerlinNoise<T>::noise0_1(double x, double y, double z) const
 {
-  return noise(x, y, z) * 0.5 + 0.5;
+  return noise(x, y, z) * (T)0.5 + (T)0.5;
 }
 
-double TG_PerlinNoise::octaveNoise(double x, double y, double z, int32 octaves)
+template <typename T>
+T TG_PerlinNoise<T>::octaveNoise(double x, double y, double z, int32 octaves) const
 {
-  double result = 0.0;
-  double amp = 1.0;
+  T result = 0;
+  T amp = 1;
 
   for (int32 i = 0; i < octaves; ++i)
   {
@@ -97,13 +142,370 @@ double TG_PerlinNoise::octaveNoise(double x, double y, double z, int32 octaves)
     x *= 2.0;
     y *= 2.0;
     z *= 2.0;
-    amp *= 0.5;
+    amp *= (T)0.5;
   }
 
   return result;
 }
 
-double TG_PerlinNoise::octaveNoise0_1(double x, double y, double z, int32 octaves)
+template <typename T>
+T TG_PerlinNoise<T>::noiseDerivatives(double x, double y, T& dNdx, T& dNdy) const
+{
+  double sub_x, sub_y;
+  const int32 unit_x = SplitCoord(x, sub_x),
+    unit_y = SplitCoord(y, sub_y);
+  const T sx = (T)sub_x,
+    sy = (T)sub_y;
+  const T u = Fade(sx),
+    v = Fade(sy),
+    du = FadeDerivative(sx),
+    dv = FadeDerivative(sy);
+
+  // Same corners as noise with z = 0, every gradient is (gx, gy)
+  const int32 a = perm[unit_x] + unit_y,
+    b = perm[unit_x + 1] + unit_y;
+  const int32 h00 = perm[perm[a]] & 15,
+    h01 = perm[perm[a + 1]] & 15,
+    h10 = perm[perm[b]] & 15,
+    h11 = perm[perm[b + 1]] & 15;
+
+  const T gx00 = GradientX[h00], gy00 = GradientY[h00];
+  const T gx10 = GradientX[h10], gy10 = GradientY[h10];
+  const T gx01 = GradientX[h01], gy01 = GradientY[h01];
+  const T gx11 = GradientX[h11], gy11 = GradientY[h11];
+
+  const T n00 = gx00 * sx + gy00 * sy;
+  const T n10 = gx10 * (sx - 1) + gy10 * sy;
+  const T n01 = gx01 * sx + gy01 * (sy - 1);
+  const T n11 = gx11 * (sx - 1) + gy11 * (sy - 1);
+
+  const T nx0 = Lerp(u, n00, n10);
+  const T nx1 = Lerp(u, n01, n11);
+
+  // Product rule on both lerps, v only depends on y
+  const T dx0 = gx00 + du * (n10 - n00) + u * (gx10 - gx00);
+  const T dx1 = gx01 + du * (n11 - n01) + u * (gx11 - gx01);
+  const T dy0 = gy00 + u * (gy10 - gy00);
+  const T dy1 = gy01 + u * (gy11 - gy01);
+
+  dNdx = Lerp(v, dx0, dx1);
+  dNdy = Lerp(v, dy0, dy1) + dv * (nx1 - nx0);
+  return Lerp(v, nx0, nx1);
+}
+
+template <typename T>
+T TG_PerlinNoise<T>::octaveNoiseDerivatives(double x, double y, int32 octaves, T& dNdx, T& dNdy) const
+{
+  T result = 0;
+  T amp = 1;
+  T frequency = 1;
+  dNdx = 0;
+  dNdy = 0;
+
+  for (int32 i = 0; i < octaves; ++i)
+  {
+    T dx, dy;
+    result += noiseDerivatives(x, y, dx, dy) * amp;
+
+    // d/dx (amp * noise(frequency * x)) = amp * frequency * noise'
+    dNdx += dx * amp * frequency;
+    dNdy += dy * amp * frequency;
+
+    x *= 2.0;
+    y *= 2.0;
+    amp *= (T)0.5;
+    frequency *= 2;
+  }
+
+  return result;
+}
+
+template <typename T>
+T TG_PerlinNoise<T>::simplexNoise(double x, double y) const
+{
+  // Skew to the simplex grid and back in double, only the offsets inside the simplex are converted to T
+  static const double F2 = 0.36602540378443865; // (sqrt(3) - 1) / 2
+  static const double G2d = 0.21132486540518713; // (3 - sqrt(3)) / 6
+  const T G2 = (T)G2d;
+
+  const double s = (x + y) * F2;
+  const double cellX = floor(x + s);
+  const double cellY = floor(y + s);
+  const double t = (cellX + cellY) * G2d;
+  const T x0 = (T)(x - (cellX - t));
+  const T y0 = (T)(y - (cellY - t));
+
+  // Lower or upper triangle of the cell
+  const int32 i1 = x0 > y0 ? 1 : 0;
+  const int32 j1 = 1 - i1;
+
+  const T x1 = x0 - i1 + G2;
+  const T y1 = y0 - j1 + G2;
+  const T x2 = x0 - 1 + 2 * G2;
+  const T y2 = y0 - 1 + 2 * G2;
+
+  const int32 ii = (int32)((int64)cellX & 255);
+  const int32 jj = (int32)((int64)cellY & 255);
+
+  T n = 0;
+  T t0 = (T)0.5 - x0 * x0 - y0 * y0;
+  if (t0 > 0) {
+    t0 *= t0;
+    n += t0 * t0 * Grad(perm[ii + perm[jj]], x0, y0, 0);
+  }
+  T t1 = (T)0.5 - x1 * x1 - y1 * y1;
+  if (t1 > 0) {
+    t1 *= t1;
+    n += t1 * t1 * Grad(perm[ii + i1 + perm[jj + j1]], x1, y1, 0);
+  }
+  T t2 = (T)0.5 - x2 * x2 - y2 * y2;
+  if (t2 > 0) {
+    t2 *= t2;
+    n += t2 * t2 * Grad(perm[ii + 1 + perm[jj + 1]], x2, y2, 0);
+  }
+
+  // Scale to [-1, 1]
+  return 70 * n;
+}
+
+template <typename T>
+T TG_PerlinNoise<T>::valueNoise(double x, double y) const
+{
+  double sub_x, sub_y;
+  const int32 unit_x = SplitCoord(x, sub_x),
+    unit_y = SplitCoord(y, sub_y);
+  const T u = Fade((T)sub_x),
+    v = Fade((T)sub_y);
+
+  // Random value of each corner in [-1, 1]
+  const T v00 = perm[perm[unit_x] + unit_y] / (T)127.5 - 1;
+  const T v10 = perm[perm[unit_x + 1] + unit_y] / (T)127.5 - 1;
+  const T v01 = perm[perm[unit_x] + unit_y + 1] / (T)127.5 - 1;
+  const T v11 = perm[perm[unit_x + 1] + unit_y + 1] / (T)127.5 - 1;
+
+  return Lerp(v, Lerp(u, v00, v10), Lerp(u, v01, v11));
+}
+
+template <typename T>
+T TG_PerlinNoise<T>::cellularNoise(double x, double y) const
+{
+  double sub_x, sub_y;
+  const int32 cell_x = SplitCoord(x, sub_x),
+    cell_y = SplitCoord(y, sub_y);
+
+  T minDistance = 2;
+  for (int32 j = -1; j <= 1; ++j) {
+    for (int32 i = -1; i <= 1; ++i) {
+      const int32 unit_x = (cell_x + i) & 255;
+      const int32 unit_y = (cell_y + j) & 255;
+
+      // Feature point of the neighbour cell
+      const int32 hash = perm[perm[unit_x] + unit_y];
+      const T dx = (i + perm[hash] / (T)255) - (T)sub_x;
+      const T dy = (j + perm[hash + 1] / (T)255) - (T)sub_y;
+      minDistance = FMath::Min(minDistance, dx * dx + dy * dy);
+    }
+  }
+
+  return (T)FMath::Sqrt((float)minDistance);
+}
+
+template <typename T>
+T TG_PerlinNoise<T>::octaveNoise0_1(double x, double y, double z, int32 octaves) const
+{
+  return octaveNoise(x, y, z, octaves) * (T)0.5 + (T)0.5;
+}
+
+template <typename T>
+void TG_PerlinNoise<T>::FillHeightGrid(double originX, double originY, double step, int32 width, int32 height, int32 octaves, float* out,
+  float* outDX, float* outDY) const
+{
+  check((outDX == nullptr) == (outDY == nullptr));
+
+  // The vector kernel is float, the double noise stays the reference
+  const bool useVectorKernel = TIsSame<T, float>::Value && CVarNoiseVectorKernel.GetValueOnAnyThread() != 0;
+
+  for (int32 row = 0; row < height; ++row) {
+    const double y = originY + row * step;
+    float* rowDX = outDX ? outDX + row * width : nullptr;
+    float* rowDY = outDY ? outDY + row * width : nullptr;
+    if (useVectorKernel) {
+      FillHeightRow(originX, y, step, width, octaves, out + row * width, rowDX, rowDY);
+    }
+    else {
+      FillHeightRowScalar(originX, y, step, width, octaves, out + row * width, rowDX, rowDY);
+    }
+  }
+}
+
+template <typename T>
+void TG_PerlinNoise<T>::FillHeightRowScalar(double originX, double y, double step, int32 width, int32 octaves, float* out,
+  float* outDX, float* outDY) const
+{
+  if (outDX) {
+    for (int32 i = 0; i < width; ++i) {
+      T dx, dy;
+      out[i] = (float)octaveNoiseDerivatives(originX + i * step, y, octaves, dx, dy);
+      outDX[i] = (float)dx;
+      outDY[i] = (float)dy;
+    }
+    return;
+  }
+
+  for (int32 i = 0; i < width; ++i) {
+    out[i] = (float)octaveNoise(originX + i * step, y, 0.0, octaves);
+  }
+}
+
+template <typename T>
+void TG_PerlinNoise<T>::FillHeightRow(double originX, double y, double step, int32 width, int32 octaves, float* out,
+  float* outDX, float* outDY) const
 {
-  return octaveNoise(x, y, z, octaves) * 0.5 + 0.5;
-}
\ No newline at end of file
+  const uint8* p = perm;
+  const bool derivatives = outDX != nullptr;
+
+  MS_ALIGN(16) float fx[NoiseChunkSize] GCC_ALIGN(16);
+  MS_ALIGN(16) float gx00[NoiseChunkSize] GCC_ALIGN(16);
+  MS_ALIGN(16) float gy00[NoiseChunkSize] GCC_ALIGN(16);
+  MS_ALIGN(16) float gx10[NoiseChunkSize] GCC_ALIGN(16);
+  MS_ALIGN(16) float gy10[NoiseChunkSize] GCC_ALIGN(16);
+  MS_ALIGN(16) float gx01[NoiseChunkSize] GCC_ALIGN(16);
+  MS_ALIGN(16) float gy01[NoiseChunkSize] GCC_ALIGN(16);
+  MS_ALIGN(16) float gx11[NoiseChunkSize] GCC_ALIGN(16);
+  MS_ALIGN(16) float gy11[NoiseChunkSize] GCC_ALIGN(16);
+  MS_ALIGN(16) float result[NoiseChunkSize] GCC_ALIGN(16);
+  MS_ALIGN(16) float resultDX[NoiseChunkSize] GCC_ALIGN(16);
+  MS_ALIGN(16) float resultDY[NoiseChunkSize] GCC_ALIGN(16);
+
+  const VectorRegister Six = VectorSetFloat1(6.f);
+  const VectorRegister MinusFifteen = VectorSetFloat1(-15.f);
+  const VectorRegister Ten = VectorSetFloat1(10.f);
+  const VectorRegister One = VectorOne();
+  const VectorRegister Thirty = VectorSetFloat1(30.f);
+
+  for (int32 chunkStart = 0; chunkStart < width; chunkStart += NoiseChunkSize) {
+    const int32 count = FMath::Min(NoiseChunkSize, width - chunkStart);
+    const int32 lanes = Align(count, 4);
+
+    VectorRegister* acc = (VectorRegister*)result;
+    VectorRegister* accDX = (VectorRegister*)resultDX;
+    VectorRegister* accDY = (VectorRegister*)resultDY;
+    for (int32 i = 0; i < lanes / 4; ++i) {
+      acc[i] = VectorZero();
+      accDX[i] = VectorZero();
+      accDY[i] = VectorZero();
+    }
+
+    double frequency = 1.0;
+    float amp = 1.f;
+
+    for (int32 octave = 0; octave < octaves; ++octave) {
+      // Split the origin in lattice cell + fraction so the lanes only carry small tile-local values
+      const double ox = (originX + chunkStart * step) * frequency;
+      const double cellX = FMath::FloorToDouble(ox);
+      const int32 baseX = (int32)((int64)cellX & 255);
+      const double fracX = ox - cellX;
+      const double stepX = step * frequency;
+
+      // The whole row shares the same Y cell
+      const double oy = y * frequency;
+      const double cellY = FMath::FloorToDouble(oy);
+      const int32 unitY = (int32)((int64)cellY & 255);
+      const float subY = (float)(oy - cellY);
+      const float fadeY = subY * subY * subY * (subY * (subY * 6.f - 15.f) + 10.f);
+      const float fadeYDerivative = 30.f * subY * subY * (subY * (subY - 2.f) + 1.f);
+
+      // Gather the lattice hashes (scalar), the math below runs on the vector lanes
+      for (int32 i = 0; i < lanes; ++i) {
+        if (i >= count) {
+          fx[i] = 0.f;
+          gx00[i] = gy00[i] = gx10[i] = gy10[i] = gx01[i] = gy01[i] = gx11[i] = gy11[i] = 0.f;
+          continue;
+        }
+        const double localX = fracX + i * stepX;
+        const double cell = FMath::FloorToDouble(localX);
+        const int32 unitX = (baseX + (int32)cell) & 255;
+        fx[i] = (float)(localX - cell);
+
+        const int32 a = p[unitX] + unitY;
+        const int32 b = p[unitX + 1] + unitY;
+        const int32 h00 = p[p[a]] & 15;
+        const int32 h01 = p[p[a + 1]] & 15;
+        const int32 h10 = p[p[b]] & 15;
+        const int32 h11 = p[p[b + 1]] & 15;
+        gx00[i] = GradientX[h00]; gy00[i] = GradientY[h00];
+        gx10[i] = GradientX[h10]; gy10[i] = GradientY[h10];
+        gx01[i] = GradientX[h01]; gy01[i] = GradientY[h01];
+        gx11[i] = GradientX[h11]; gy11[i] = GradientY[h11];
+      }
+
+      const VectorRegister Y0 = VectorSetFloat1(subY);
+      const VectorRegister Y1 = VectorSetFloat1(subY - 1.f);
+      const VectorRegister V = VectorSetFloat1(fadeY);
+      const VectorRegister Amp = VectorSetFloat1(amp);
+      const VectorRegister DV = VectorSetFloat1(fadeYDerivative);
+      const VectorRegister AmpFrequency = VectorSetFloat1(amp * (float)frequency);
+
+      for (int32 i = 0; i < lanes; i += 4) {
+        const VectorRegister X0 = VectorLoadAligned(&fx[i]);
+        const VectorRegister X1 = VectorSubtract(X0, One);
+
+        // Fade(x) = x^3 * (x * (x * 6 - 15) + 10)
+        VectorRegister U = VectorMultiplyAdd(X0, Six, MinusFifteen);
+        U = VectorMultiplyAdd(X0, U, Ten);
+        U = VectorMultiply(VectorMultiply(VectorMultiply(X0, X0), X0), U);
+
+        const VectorRegister N00 = VectorMultiplyAdd(VectorLoadAligned(&gx00[i]), X0, VectorMultiply(VectorLoadAligned(&gy00[i]), Y0));
+        const VectorRegister N10 = VectorMultiplyAdd(VectorLoadAligned(&gx10[i]), X1, VectorMultiply(VectorLoadAligned(&gy10[i]), Y0));
+        const VectorRegister N01 = VectorMultiplyAdd(VectorLoadAligned(&gx01[i]), X0, VectorMultiply(VectorLoadAligned(&gy01[i]), Y1));
+        const VectorRegister N11 = VectorMultiplyAdd(VectorLoadAligned(&gx11[i]), X1, VectorMultiply(VectorLoadAligned(&gy11[i]), Y1));
+
+        // Lerp(t, a, b) = a + t * (b - a)
+        const VectorRegister NX0 = VectorMultiplyAdd(U, VectorSubtract(N10, N00), N00);
+        const VectorRegister NX1 = VectorMultiplyAdd(U, VectorSubtract(N11, N01), N01);
+        const VectorRegister N = VectorMultiplyAdd(V, VectorSubtract(NX1, NX0), NX0);
+
+        acc[i / 4] = VectorMultiplyAdd(N, Amp, acc[i / 4]);
+
+        if (derivatives) {
+          // Fade'(x) = 30 * x^2 * (x - 1)^2
+          const VectorRegister X0X1 = VectorMultiply(X0, X1);
+          const VectorRegister DU = VectorMultiply(Thirty, VectorMultiply(X0X1, X0X1));
+
+          const VectorRegister GX00 = VectorLoadAligned(&gx00[i]);
+          const VectorRegister GX10 = VectorLoadAligned(&gx10[i]);
+          const VectorRegister GX01 = VectorLoadAligned(&gx01[i]);
+          const VectorRegister GX11 = VectorLoadAligned(&gx11[i]);
+          const VectorRegister GY00 = VectorLoadAligned(&gy00[i]);
+          const VectorRegister GY10 = VectorLoadAligned(&gy10[i]);
+          const VectorRegister GY01 = VectorLoadAligned(&gy01[i]);
+          const VectorRegister GY11 = VectorLoadAligned(&gy11[i]);
+
+          // Same product rule as noiseDerivatives
+          const VectorRegister DX0 = VectorAdd(VectorMultiplyAdd(DU, VectorSubtract(N10, N00), GX00), VectorMultiply(U, VectorSubtract(GX10, GX00)));
+          const VectorRegister DX1 = VectorAdd(VectorMultiplyAdd(DU, VectorSubtract(N11, N01), GX01), VectorMultiply(U, VectorSubtract(GX11, GX01)));
+          const VectorRegister DY0 = VectorMultiplyAdd(U, VectorSubtract(GY10, GY00), GY00);
+          const VectorRegister DY1 = VectorMultiplyAdd(U, VectorSubtract(GY11, GY01), GY01);
+
+          const VectorRegister DNX = VectorMultiplyAdd(V, VectorSubtract(DX1, DX0), DX0);
+          const VectorRegister DNY = VectorMultiplyAdd(DV, VectorSubtract(NX1, NX0), VectorMultiplyAdd(V, VectorSubtract(DY1, DY0), DY0));
+
+          accDX[i / 4] = VectorMultiplyAdd(DNX, AmpFrequency, accDX[i / 4]);
+          accDY[i / 4] = VectorMultiplyAdd(DNY, AmpFrequency, accDY[i / 4]);
+        }
+      }
+
+      frequency *= 2.0;
+      amp *= 0.5f;
+    }
+
+    FMemory::Memcpy(out + chunkStart, result, count * sizeof(float));
+    if (derivatives) {
+      FMemory::Memcpy(outDX + chunkStart, resultDX, count * sizeof(float));
+      FMemory::Memcpy(outDY + chunkStart, resultDY, count * sizeof(float));
+    }
+  }
+}
+
+template class TG_PerlinNoise<float>;
+template class TG_PerlinNoise<double>;
@@ -0,0 +1,472 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#include "TG_TerrainBenchCommandlet.h"
+#include "TG_TerrainGenerator.h"
+#include "TG_TileBuilder.h"
+#include "TG_TileLOD.h"
+#include "RuntimeMeshLibrary.h"
+#include "Engine/StaticMesh.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/IConsoleManager.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTerrainBench, Log, All);
+
+// Written by the benchmarks so the compiler keeps the measured work
+static volatile double GBenchSink = 0.0;
+
+/*
+  Copy of FRuntimeMeshInternalUtilities::FindDuplicateVerticesMap, which is private to RuntimeMeshComponent:
+  the vertices sorted by a weighted sum of XYZ, then only the neighbours within the threshold are compared.
+*/
+static TMultiMap<uint32, uint32> FindDuplicateVerticesMap(const TArray<FVector>& vertices)
+{
+  struct FSortingElement {
+    float Value;
+    int32 Index;
+  };
+
+  const int32 numVertices = vertices.Num();
+  TArray<FSortingElement> sorter;
+  sorter.SetNumUninitialized(numVertices);
+  for (int32 i = 0; i < numVertices; ++i) {
+    sorter[i].Value = 0.30f * vertices[i].X + 0.33f * vertices[i].Y + 0.37f * vertices[i].Z;
+    sorter[i].Index = i;
+  }
+  sorter.Sort([](const FSortingElement& left, const FSortingElement& right) {
+    return left.Value < right.Value;
+  });
+
+  TMultiMap<uint32, uint32> duplicates;
+  for (int32 i = 0; i < numVertices; ++i) {
+    const uint32 source = sorter[i].Index;
+    for (int32 j = i + 1; j < numVertices; ++j) {
+      if (FMath::Abs(sorter[j].Value - sorter[i].Value) > THRESH_POINTS_ARE_SAME * 4.01f) {
+        break;
+      }
+      const uint32 other = sorter[j].Index;
+      if (vertices[source].Equals(vertices[other], 0.f)) {
+        duplicates.AddUnique(source, other);
+        duplicates.AddUnique(other, source);
+      }
+    }
+  }
+  return duplicates;
+}
+
+/* Runs the benchmarks and keeps their results */
+class FTG_BenchmarkRunner
+{
+public:
+  FString Filter;
+  double MinTime = 0.25;
+  int MinIterations = 3;
+  int MaxIterations = 100000;
+
+  TArray<TSharedPtr<FJsonValue>> Results;
+  // Accuracy checks over their tolerance, the commandlet fails when there is any
+  int Failures = 0;
+
+  /* Fail the run when error is over tolerance */
+  void Check(const FString& name, double error, double tolerance)
+  {
+    if (error > tolerance) {
+      UE_LOG(LogTerrainBench, Error, TEXT("%s: error %g over the tolerance %g"), *name, error, tolerance);
+      ++Failures;
+    }
+    else {
+      UE_LOG(LogTerrainBench, Display, TEXT("%s: error %g (tolerance %g)"), *name, error, tolerance);
+    }
+  }
+
+  /* Measure body, itemsPerIteration is the work done by one call (samples, vertices...) */
+  void Run(const FString& name, int64 itemsPerIteration, TFunctionRef<void()> body)
+  {
+    if (!Filter.IsEmpty() && !name.Contains(Filter)) {
+      return;
+    }
+
+    // Warm up the caches and the lazy allocations
+    body();
+
+    TArray<double> samples;
+    double measured = 0.0;
+    while ((measured < MinTime || samples.Num() < MinIterations) && samples.Num() < MaxIterations) {
+      double start = FPlatformTime::Seconds();
+      body();
+      double elapsed = FPlatformTime::Seconds() - start;
+
+      samples.Add(elapsed);
+      measured += elapsed;
+    }
+
+    samples.Sort();
+    double minTime = samples[0];
+    double medianTime = samples[samples.Num() / 2];
+    double meanTime = measured / samples.Num();
+
+    TSharedPtr<FJsonObject> result = MakeShareable(new FJsonObject());
+    result->SetStringField(TEXT("name"), name);
+    result->SetNumberField(TEXT("iterations"), samples.Num());
+    result->SetNumberField(TEXT("items"), (double)itemsPerIteration);
+    result->SetNumberField(TEXT("min_ns"), minTime * 1e9);
+    result->SetNumberField(TEXT("median_ns"), medianTime * 1e9);
+    result->SetNumberField(TEXT("mean_ns"), meanTime * 1e9);
+    result->SetNumberField(TEXT("items_per_sec"), itemsPerIteration / FMath::Max(medianTime, 1e-12));
+    Results.Add(MakeShareable(new FJsonValueObject(result)));
+
+    UE_LOG(LogTerrainBench, Display, TEXT("%-56s %8d it %14.1f ns/it %14.1f items/s"),
+      *name, samples.Num(), medianTime * 1e9, itemsPerIteration / FMath::Max(medianTime, 1e-12));
+  }
+};
+
+UTG_TerrainBenchCommandlet::UTG_TerrainBenchCommandlet()
+{
+  IsClient = false;
+  IsServer = false;
+  IsEditor = false;
+  LogToConsole = true;
+  ShowErrorCount = true;
+}
+
+/* Settings of a Tile with lineSize vertices per line and numBiomes Biomes with colors and assets */
+static FTG_GenerationParamsPtr MakeBenchParams(int seed, int lineSize, int numBiomes, UStaticMesh* assetMesh)
+{
+  ATG_TerrainGenerator* generator = NewObject<ATG_TerrainGenerator>(GetTransientPackage());
+  generator->randomSeed = false;
+  generator->useRuntime = false;
+  generator->Seed = seed;
+
+  generator->tileSettings.bOptimalLOD = false;
+  generator->tileSettings.LevelOfDetail = generator->tileSettings.TileSize / (lineSize - 1);
+
+  // Biomes splitting the height in equal bands
+  generator->useVertexColor = numBiomes > 0;
+  generator->spawnAssets = numBiomes > 0;
+  generator->biomeList.Reset();
+  for (int i = 0; i < numBiomes; ++i) {
+    FBiomeSettings biome;
+    biome.biomeName = *FString::Printf(TEXT("Biome%d"), i);
+    biome.minHeight = (float)i / numBiomes;
+    biome.maxHeight = (float)(i + 1) / numBiomes;
+    biome.vertexColors.Add(FColor::MakeRandomColor());
+    biome.vertexColors.Add(FColor::MakeRandomColor());
+    biome.asset.probability = 0.05f;
+    biome.asset.randomRotation = true;
+    biome.asset.randomScale = true;
+    biome.asset.mesh = assetMesh;
+    generator->biomeList.Add(biome);
+  }
+
+  generator->tileSettings.Init();
+  generator->InitAlgorithm();
+  return generator->GetGenerationParams();
+}
+
+static void BenchNoise(FTG_BenchmarkRunner& runner, const FTG_GenerationParams& params)
+{
+  const int Samples = 64 * 1024;
+  const TG_PerlinNoise<float>& noise = params.perlinNoiseTerrain;
+
+  // Same permutation in double, the reference of the float noise
+  TG_PerlinNoise<double> reference;
+  reference.setNoiseSeed(params.Seed);
+
+  runner.Run(TEXT("noise/noise"), Samples, [&noise]() {
+    double sum = 0.0;
+    for (int i = 0; i < Samples; ++i) {
+      sum += noise.noise((i & 255) * 0.37, (i >> 8) * 0.61, 0.5);
+    }
+    GBenchSink = sum;
+  });
+
+  for (int octaves : { 1, 4, 8 }) {
+    runner.Run(FString::Printf(TEXT("noise/octaveNoise/octaves=%d"), octaves), Samples, [&noise, octaves]() {
+      double sum = 0.0;
+      for (int i = 0; i < Samples; ++i) {
+        sum += noise.octaveNoise((i & 255) * 0.037, (i >> 8) * 0.061, 0.0, octaves);
+      }
+      GBenchSink = sum;
+    });
+  }
+
+  for (int octaves : { 1, 8 }) {
+    TArray<float> grid;
+    grid.SetNumUninitialized(Samples);
+    runner.Run(FString::Printf(TEXT("noise/FillHeightGrid/octaves=%d"), octaves), Samples, [&noise, &grid, octaves]() {
+      noise.FillHeightGrid(0.25, 0.25, 0.037, 256, Samples / 256, octaves, grid.GetData());
+      GBenchSink = grid[Samples - 1];
+    });
+  }
+
+  runner.Run(TEXT("noise/octaveNoise/double/octaves=8"), Samples, [&reference]() {
+    double sum = 0.0;
+    for (int i = 0; i < Samples; ++i) {
+      sum += reference.octaveNoise((i & 255) * 0.037, (i >> 8) * 0.061, 0.0, 8);
+    }
+    GBenchSink = sum;
+  });
+
+  // The float noise matches the double path within 1e-5, also far from the origin,
+  // where world positions in float would lose the detail of the noise
+  for (double origin : { 0.25, 100000.25 }) {
+    TArray<float> grid;
+    TArray<float> referenceGrid;
+    grid.SetNumUninitialized(Samples);
+    referenceGrid.SetNumUninitialized(Samples);
+    noise.FillHeightGrid(origin, -origin, 0.037, 256, Samples / 256, 8, grid.GetData());
+    reference.FillHeightGrid(origin, -origin, 0.037, 256, Samples / 256, 8, referenceGrid.GetData());
+
+    float maxError = 0.f;
+    for (int i = 0; i < Samples; ++i) {
+      maxError = FMath::Max(maxError, FMath::Abs(grid[i] - referenceGrid[i]));
+    }
+    runner.Check(FString::Printf(TEXT("FillHeightGrid float vs double at %g"), origin), maxError, 1e-5);
+  }
+
+  // The vector kernel matches the scalar path within 1e-5, at the origin and far from it
+  IConsoleVariable* vectorKernel = IConsoleManager::Get().FindConsoleVariable(TEXT("tg.Noise.VectorKernel"));
+  if (vectorKernel) {
+    const int32 previous = vectorKernel->GetInt();
+    for (double origin : { 0.25, 100000.25 }) {
+      TArray<float> vectorGrid;
+      TArray<float> scalarGrid;
+      vectorGrid.SetNumUninitialized(Samples);
+      scalarGrid.SetNumUninitialized(Samples);
+
+      vectorKernel->Set(1, ECVF_SetByCode);
+      noise.FillHeightGrid(origin, -origin, 0.037, 256, Samples / 256, 8, vectorGrid.GetData());
+      vectorKernel->Set(0, ECVF_SetByCode);
+      noise.FillHeightGrid(origin, -origin, 0.037, 256, Samples / 256, 8, scalarGrid.GetData());
+
+      float maxError = 0.f;
+      for (int i = 0; i < Samples; ++i) {
+        maxError = FMath::Max(maxError, FMath::Abs(vectorGrid[i] - scalarGrid[i]));
+      }
+      runner.Check(FString::Printf(TEXT("FillHeightGrid vector vs scalar at %g"), origin), maxError, 1e-5);
+    }
+    vectorKernel->Set(previous, ECVF_SetByCode);
+  }
+
+  {
+    // Heights and slopes in one pass (analytic normals)
+    TArray<float> grid;
+    TArray<float> gridDX;
+    TArray<float> gridDY;
+    grid.SetNumUninitialized(Samples);
+    gridDX.SetNumUninitialized(Samples);
+    gridDY.SetNumUninitialized(Samples);
+    runner.Run(TEXT("noise/FillHeightGrid/derivatives/octaves=8"), Samples, [&noise, &grid, &gridDX, &gridDY]() {
+      noise.FillHeightGrid(0.25, 0.25, 0.037, 256, Samples / 256, 8, grid.GetData(), gridDX.GetData(), gridDY.GetData());
+      GBenchSink = gridDX[Samples - 1] + gridDY[Samples - 1];
+    });
+
+    // Against central differences of the double noise (filled again, the benchmark can be filtered out).
+    // The slopes of 8 octaves reach about 20, so 1e-3 is float precision plus the difference error
+    noise.FillHeightGrid(0.25, 0.25, 0.037, 256, Samples / 256, 8, grid.GetData(), gridDX.GetData(), gridDY.GetData());
+    const double Epsilon = 1e-6;
+    double maxError = 0.0;
+    for (int i = 0; i < Samples; i += 61) {
+      const double x = 0.25 + (i & 255) * 0.037;
+      const double y = 0.25 + (i >> 8) * 0.037;
+      const double dX = (reference.octaveNoise(x + Epsilon, y, 0.0, 8) - reference.octaveNoise(x - Epsilon, y, 0.0, 8)) / (2.0 * Epsilon);
+      const double dY = (reference.octaveNoise(x, y + Epsilon, 0.0, 8) - reference.octaveNoise(x, y - Epsilon, 0.0, 8)) / (2.0 * Epsilon);
+      maxError = FMath::Max(maxError, FMath::Max(FMath::Abs(gridDX[i] - dX), FMath::Abs(gridDY[i] - dY)));
+    }
+    runner.Check(TEXT("FillHeightGrid derivatives vs central differences"), maxError, 1e-3);
+  }
+
+  // Noise Graphs: the default terrain, and a warped ridged terrain with terraces
+  FNoiseGraph defaultGraph;
+  FNoiseGraphNode perlin;
+  perlin.octaves = 8;
+  FNoiseGraphNode remap;
+  remap.type = NoiseNodeType::NoiseNode_ScaleBias;
+  remap.inputA = 0;
+  remap.scale = 0.5f;
+  remap.bias = 0.5f;
+  defaultGraph.nodes = { perlin, remap };
+
+  FNoiseGraph warpedGraph;
+  FNoiseGraphNode warpX;
+  warpX.type = NoiseNodeType::NoiseNode_Simplex;
+  warpX.octaves = 2;
+  warpX.seedOffset = 1;
+  FNoiseGraphNode warpY = warpX;
+  warpY.seedOffset = 2;
+  FNoiseGraphNode warp;
+  warp.type = NoiseNodeType::NoiseNode_DomainWarp;
+  warp.inputA = 0;
+  warp.inputB = 1;
+  warp.scale = 0.5f;
+  FNoiseGraphNode ridged;
+  ridged.type = NoiseNodeType::NoiseNode_Ridged;
+  ridged.octaves = 6;
+  ridged.coords = 2;
+  FNoiseGraphNode terrace;
+  terrace.type = NoiseNodeType::NoiseNode_Terrace;
+  terrace.inputA = 3;
+  terrace.smoothness = 0.5f;
+  warpedGraph.nodes = { warpX, warpY, warp, ridged, terrace };
+
+  auto BenchGraph = [&runner, &params](const TCHAR* name, const FNoiseGraph& graph) {
+    FString error;
+    FTG_NoiseProgramPtr program = FTG_NoiseProgram::Compile(graph, params.Seed, error);
+    if (!program.IsValid()) {
+      UE_LOG(LogTerrainBench, Warning, TEXT("Noise Graph %s: %s"), name, *error);
+      return;
+    }
+
+    TArray<float> grid;
+    grid.SetNumUninitialized(Samples);
+    runner.Run(FString::Printf(TEXT("noise/NoiseGraph/%s"), name), Samples, [&program, &grid]() {
+      program->EvaluateGrid(0.25, 0.25, 0.037, 256, Samples / 256, grid.GetData());
+      GBenchSink = grid[Samples - 1];
+    });
+  };
+  BenchGraph(TEXT("default"), defaultGraph);
+  BenchGraph(TEXT("warped"), warpedGraph);
+}
+
+static void BenchTile(FTG_BenchmarkRunner& runner, const FTG_GenerationParams& params)
+{
+  int lineSize = params.tileSettings.getArrayLineSize();
+  int numVertices = params.tileSettings.ArraySize;
+
+  FTG_TileBuildResult result;
+  FTG_TileBuilder builder(params, result);
+  builder.InitMeshToCreate();
+
+  runner.Run(FString::Printf(TEXT("tile/GenerateVertices/line=%d"), lineSize), numVertices, [&builder]() {
+    builder.GenerateVertices();
+  });
+
+  TArray<int32> triangles;
+  FTG_LODStitch stitch;
+  FTG_TileLOD::BuildTriangles(lineSize, stitch, triangles);
+  runner.Run(FString::Printf(TEXT("tile/GenerateTriangles/line=%d"), lineSize), triangles.Num() / 3, [lineSize, &stitch, &triangles]() {
+    FTG_TileLOD::BuildTriangles(lineSize, stitch, triangles);
+  });
+
+  runner.Run(FString::Printf(TEXT("tile/GenerateNormalTangents/line=%d"), lineSize), numVertices, [&builder]() {
+    builder.GenerateNormalTangents();
+  });
+
+  runner.Run(FString::Printf(TEXT("tile/Build/line=%d"), lineSize), numVertices, [&params]() {
+    FTG_TileBuildResult buildResult;
+    FTG_TileBuilder(params, buildResult).Build(0, 1, 1);
+  });
+}
+
+static void BenchRuntimeMesh(FTG_BenchmarkRunner& runner, const FTG_GenerationParams& params)
+{
+  int lineSize = params.tileSettings.getArrayLineSize();
+
+  // Positions and UVs of the Tile at (1, 1)
+  FTG_TileBuildResult result;
+  FTG_TileBuilder(params, result).Build(0, 1, 1);
+  FRuntimeMeshBuilder& mesh = *result.LODMeshes[0];
+
+  TArray<FVector> vertices;
+  TArray<FVector2D> uvs;
+  vertices.SetNumUninitialized(mesh.NumVertices());
+  uvs.SetNumUninitialized(mesh.NumVertices());
+  for (int i = 0; i < mesh.NumVertices(); ++i) {
+    vertices[i] = mesh.GetPosition(i);
+    uvs[i] = mesh.GetUV(i);
+  }
+
+  TArray<int32> triangles;
+  FTG_TileLOD::BuildTriangles(lineSize, FTG_LODStitch(), triangles);
+
+  TArray<FVector> normals;
+  TArray<FRuntimeMeshTangent> tangents;
+  for (bool smooth : { true, false }) {
+    runner.Run(FString::Printf(TEXT("rmc/CalculateTangentsForMesh/%s/line=%d"), smooth ? TEXT("smooth") : TEXT("flat"), lineSize), vertices.Num(),
+      [&vertices, &triangles, &normals, &uvs, &tangents, smooth]() {
+      URuntimeMeshLibrary::CalculateTangentsForMesh(vertices, triangles, normals, uvs, tangents, smooth);
+    });
+  }
+
+  runner.Run(FString::Printf(TEXT("rmc/FindDuplicateVerticesMap/line=%d"), lineSize), vertices.Num(), [&vertices]() {
+    TMultiMap<uint32, uint32> duplicates = FindDuplicateVerticesMap(vertices);
+    GBenchSink = duplicates.Num();
+  });
+}
+
+static void BenchBiomes(FTG_BenchmarkRunner& runner, const FTG_GenerationParams& params)
+{
+  int numBiomes = params.biomeList.Num();
+  int numVertices = params.tileSettings.ArraySize;
+
+  FTG_TileBuildResult result;
+  FTG_TileBuilder builder(params, result);
+  builder.InitMeshToCreate();
+  builder.GenerateVertices();
+
+  runner.Run(FString::Printf(TEXT("biomes/SetupBiomes/biomes=%d"), numBiomes), numVertices, [&builder]() {
+    builder.SetupBiomes();
+  });
+  runner.Run(FString::Printf(TEXT("biomes/SetupAssets/biomes=%d"), numBiomes), numVertices, [&builder]() {
+    builder.SetupAssets();
+  });
+}
+
+int32 UTG_TerrainBenchCommandlet::Main(const FString& Params)
+{
+  FTG_BenchmarkRunner runner;
+  FParse::Value(*Params, TEXT("Filter="), runner.Filter);
+  float minTime = 0.f;
+  if (FParse::Value(*Params, TEXT("MinTime="), minTime)) {
+    runner.MinTime = minTime;
+  }
+
+  int seed = 3140;
+  FParse::Value(*Params, TEXT("Seed="), seed);
+
+  FString outputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("TerrainBench.json");
+  FParse::Value(*Params, TEXT("Output="), outputPath);
+
+  // Only the pointer of the asset mesh is used
+  UStaticMesh* assetMesh = NewObject<UStaticMesh>(GetTransientPackage());
+  assetMesh->AddToRoot();
+
+  BenchNoise(runner, *MakeBenchParams(seed, 65, 0, nullptr));
+
+  for (int lineSize : { 33, 65, 129, 257 }) {
+    FTG_GenerationParamsPtr params = MakeBenchParams(seed, lineSize, 0, nullptr);
+    BenchTile(runner, *params);
+    if (lineSize <= 129) {
+      BenchRuntimeMesh(runner, *params);
+    }
+  }
+
+  for (int numBiomes : { 1, 4, 8, 16, 32 }) {
+    BenchBiomes(runner, *MakeBenchParams(seed, 129, numBiomes, assetMesh));
+  }
+
+  assetMesh->RemoveFromRoot();
+
+  // Results
+  TSharedRef<FJsonObject> root = MakeShareable(new FJsonObject());
+  root->SetNumberField(TEXT("version"), 1);
+  root->SetStringField(TEXT("platform"), FString(FPlatformProperties::PlatformName()));
+  root->SetStringField(TEXT("cpu"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+  root->SetNumberField(TEXT("cores"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+  root->SetNumberField(TEXT("seed"), seed);
+  root->SetArrayField(TEXT("benchmarks"), runner.Results);
+
+  FString json;
+  TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+  FJsonSerializer::Serialize(root, writer);
+
+  if (!FFileHelper::SaveStringToFile(json, *outputPath)) {
+    UE_LOG(LogTerrainBench, Error, TEXT("Could not write %s"), *outputPath);
+    return 1;
+  }
+  UE_LOG(LogTerrainBench, Display, TEXT("%d benchmarks written to %s"), runner.Results.Num(), *outputPath);
+  return runner.Failures > 0 ? 1 : 0;
+}
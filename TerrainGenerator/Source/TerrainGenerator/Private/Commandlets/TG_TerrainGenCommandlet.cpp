@@ -0,0 +1,196 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#include "TG_TerrainGenCommandlet.h"
+#include "TG_TerrainGenerator.h"
+#include "TG_TileBuilder.h"
+#include "TG_TileCache.h"
+#include "TG_WorldPack.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Modules/ModuleManager.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTerrainGenCommandlet, Log, All);
+
+UTG_TerrainGenCommandlet::UTG_TerrainGenCommandlet()
+{
+  IsClient = false;
+  IsServer = false;
+  IsEditor = false;
+  LogToConsole = true;
+  ShowErrorCount = true;
+}
+
+/* Generator with the settings of the command line, not placed in any world */
+static ATG_TerrainGenerator* CreateGenerator(const FString& Params)
+{
+  UClass* generatorClass = ATG_TerrainGenerator::StaticClass();
+  FString generatorPath;
+  if (FParse::Value(*Params, TEXT("Generator="), generatorPath)) {
+    generatorClass = LoadClass<ATG_TerrainGenerator>(nullptr, *generatorPath);
+    if (generatorClass == nullptr) {
+      UE_LOG(LogTerrainGenCommandlet, Error, TEXT("Could not load the Generator %s"), *generatorPath);
+      return nullptr;
+    }
+  }
+
+  ATG_TerrainGenerator* generator = NewObject<ATG_TerrainGenerator>(GetTransientPackage(), generatorClass);
+  generator->randomSeed = false;
+  generator->useRuntime = false;
+  generator->useTileCache = FParse::Param(*Params, TEXT("UseCache"));
+
+  FParse::Value(*Params, TEXT("Seed="), generator->Seed);
+  FParse::Value(*Params, TEXT("Octaves="), generator->Octaves);
+  FParse::Value(*Params, TEXT("TileSize="), generator->tileSettings.TileSize);
+
+  float value = 0.f;
+  if (FParse::Value(*Params, TEXT("Amplitude="), value)) {
+    generator->Amplitude = value;
+  }
+  if (FParse::Value(*Params, TEXT("Frequency="), value)) {
+    generator->Frequency = value;
+  }
+
+  // Same as CreateTerrain
+  generator->tileSettings.Init();
+  generator->InitAlgorithm();
+  return generator;
+}
+
+/* Heights of the region normalized with the Seed-wide max height */
+static bool WriteHeightmaps(const FString& Params, const TArray<uint16>& heightmap, int width)
+{
+  bool success = true;
+
+  FString rawPath;
+  if (FParse::Value(*Params, TEXT("HeightmapRaw="), rawPath)) {
+    TArray<uint8> bytes;
+    bytes.SetNumUninitialized(heightmap.Num() * sizeof(uint16));
+    for (int i = 0; i < heightmap.Num(); ++i) {
+      bytes[2 * i] = heightmap[i] & 0xFF;
+      bytes[2 * i + 1] = heightmap[i] >> 8;
+    }
+    success &= FFileHelper::SaveArrayToFile(bytes, *rawPath);
+    UE_LOG(LogTerrainGenCommandlet, Display, TEXT("Heightmap %dx%d written to %s"), width, width, *rawPath);
+  }
+
+  FString pngPath;
+  if (FParse::Value(*Params, TEXT("HeightmapPNG="), pngPath)) {
+    IImageWrapperModule& imageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+    TSharedPtr<IImageWrapper> imageWrapper = imageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+    if (imageWrapper.IsValid() && imageWrapper->SetRaw(heightmap.GetData(), heightmap.Num() * sizeof(uint16), width, width, ERGBFormat::Gray, 16)) {
+      success &= FFileHelper::SaveArrayToFile(imageWrapper->GetCompressed(), *pngPath);
+      UE_LOG(LogTerrainGenCommandlet, Display, TEXT("Heightmap %dx%d written to %s"), width, width, *pngPath);
+    }
+    else {
+      success = false;
+    }
+  }
+
+  return success;
+}
+
+static void LogStage(const TCHAR* name, double seconds, int numTiles)
+{
+  UE_LOG(LogTerrainGenCommandlet, Display, TEXT("  %-10s %10.3f s %10.3f ms/tile"), name, seconds, seconds * 1000.0 / FMath::Max(numTiles, 1));
+}
+
+int32 UTG_TerrainGenCommandlet::Main(const FString& Params)
+{
+  ATG_TerrainGenerator* generator = CreateGenerator(Params);
+  if (generator == nullptr) {
+    return 1;
+  }
+  FTG_GenerationParamsPtr params = generator->GetGenerationParams();
+
+  int size = 8;
+  int originX = 0;
+  int originY = 0;
+  FParse::Value(*Params, TEXT("Tiles="), size);
+  FParse::Value(*Params, TEXT("OriginX="), originX);
+  FParse::Value(*Params, TEXT("OriginY="), originY);
+  size = FMath::Max(size, 1);
+  bool singleThread = FParse::Param(*Params, TEXT("SingleThread"));
+
+  // Optional outputs
+  FString packPath;
+  FTG_WorldPackWriter packWriter;
+  bool writePack = FParse::Value(*Params, TEXT("Pack="), packPath);
+  if (writePack && !packWriter.Open(packPath, *params, size * size)) {
+    return 1;
+  }
+
+  FString heightmapPath;
+  bool writeHeightmap = FParse::Value(*Params, TEXT("HeightmapRaw="), heightmapPath) || FParse::Value(*Params, TEXT("HeightmapPNG="), heightmapPath);
+  int lineSize = params->tileSettings.getArrayLineSize();
+  int width = size * (lineSize - 1) + 1;
+  TArray<uint16> heightmap;
+  if (writeHeightmap) {
+    heightmap.SetNumZeroed(width * width);
+  }
+
+  UE_LOG(LogTerrainGenCommandlet, Display, TEXT("Generating %dx%d Tiles of %dx%d vertices, Seed %d, %s"),
+    size, size, lineSize, lineSize, params->Seed, singleThread ? TEXT("1 thread") : TEXT("all cores"));
+
+  FCriticalSection timingsLock;
+  FTG_TileBuildTimings timings;
+  double startTime = FPlatformTime::Seconds();
+
+  ParallelFor(size * size, [&](int32 index) {
+    int tileX = index % size;
+    int tileY = index / size;
+
+    FTG_TileBuildResult result;
+    FTG_TileBuilder(*params, result).Build(index, originX + tileX, originY + tileY);
+
+    if (writeHeightmap) {
+      // The border vertices are shared, the last Tile of each line writes them
+      float invMaxHeight = params->maxHeight > 0.f ? 1.f / params->maxHeight : 0.f;
+      int lastX = tileX == size - 1 ? lineSize : lineSize - 1;
+      int lastY = tileY == size - 1 ? lineSize : lineSize - 1;
+      for (int y = 0; y < lastY; ++y) {
+        uint16* row = &heightmap[(tileY * (lineSize - 1) + y) * width + tileX * (lineSize - 1)];
+        for (int x = 0; x < lastX; ++x) {
+          float normalized = FMath::Clamp(result.HeightField[x + y * lineSize] * invMaxHeight, 0.f, 1.f);
+          row[x] = (uint16)FMath::RoundToInt(normalized * 65535.f);
+        }
+      }
+    }
+
+    if (writePack) {
+      TArray<uint8> chunk;
+      FTG_TileCache::WriteChunk(*params, *result.LODMeshes[0], result, chunk);
+      packWriter.AddTile(originX + tileX, originY + tileY, chunk);
+    }
+
+    FScopeLock ScopeLock(&timingsLock);
+    timings.Add(result.Timings);
+  }, singleThread);
+
+  double elapsed = FPlatformTime::Seconds() - startTime;
+  int numTiles = size * size;
+
+  // Report
+  UE_LOG(LogTerrainGenCommandlet, Display, TEXT("Generated %d Tiles in %.3f s: %.2f tiles/s"), numTiles, elapsed, numTiles / FMath::Max(elapsed, 1e-9));
+  UE_LOG(LogTerrainGenCommandlet, Display, TEXT("Stages (summed over all threads):"));
+  LogStage(TEXT("Init"), timings.Init, numTiles);
+  LogStage(TEXT("Load"), timings.Load, numTiles);
+  LogStage(TEXT("Vertices"), timings.Vertices, numTiles);
+  LogStage(TEXT("Normals"), timings.Normals, numTiles);
+  LogStage(TEXT("Biomes"), timings.Biomes, numTiles);
+  LogStage(TEXT("Assets"), timings.Assets, numTiles);
+  LogStage(TEXT("Save"), timings.Save, numTiles);
+  LogStage(TEXT("LODs"), timings.LODs, numTiles);
+  LogStage(TEXT("Total"), timings.Total(), numTiles);
+
+  bool success = true;
+  if (writePack) {
+    success &= packWriter.Close();
+  }
+  if (writeHeightmap) {
+    success &= WriteHeightmaps(Params, heightmap, width);
+  }
+  return success ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#include "TG_GenerationParams.h"
+#include "Serialization/MemoryWriter.h"
+#include "Hash/CityHash.h"
+#include "Async/ParallelFor.h"
+#include "Engine/StaticMesh.h"
+#include "Misc/ScopeLock.h"
+
+FTG_AssetParams::FTG_AssetParams(const FAssetSettings& settings)
+  : probability(settings.probability)
+  , collision(settings.collision)
+  , randomRotation(settings.randomRotation)
+  , randomScale(settings.randomScale)
+  , maxRandomScale(settings.maxRandomScale)
+  , hasMesh(settings.mesh != nullptr)
+  , mesh(settings.mesh) {
+}
+
+FTG_BiomeParams::FTG_BiomeParams(const FBiomeSettings& settings)
+  : minHeight(settings.minHeight)
+  , maxHeight(settings.maxHeight)
+  , vertexColors(settings.vertexColors)
+  , asset(settings.asset) {
+}
+
+TSharedPtr<FTG_GenerationParams, ESPMode::ThreadSafe> FTG_GenerationParams::Allocate() {
+  void* memory = FMemory::Malloc(sizeof(FTG_GenerationParams), alignof(FTG_GenerationParams));
+  return MakeShareable(new (memory) FTG_GenerationParams(), [](FTG_GenerationParams* params) {
+    params->~FTG_GenerationParams();
+    FMemory::Free(params);
+  });
+}
+
+void FTG_GenerationParams::GetAlgorithmGrid(double x, double y, double spacing, int lineSize, float* out,
+  float* outDX, float* outDY) const {
+  double totalFreq = Frequency * tileSettings.getTileSize();
+  const int size = lineSize * lineSize;
+  check(outDX == nullptr || HasAnalyticNormals());
+
+  // The graph output is already in the range of octaveNoise0_1
+  if (noiseProgram.IsValid()) {
+    noiseProgram->EvaluateGrid(x / totalFreq, y / totalFreq, spacing / totalFreq, lineSize, lineSize, out);
+    for (int i = 0; i < size; ++i) {
+      out[i] *= Amplitude;
+    }
+    return;
+  }
+
+  perlinNoiseTerrain.FillHeightGrid(x / totalFreq, y / totalFreq, spacing / totalFreq, lineSize, lineSize, Octaves, out, outDX, outDY);
+
+  // Same mapping as octaveNoise0_1 and the Amplitude in GetAlgorithmValue
+  for (int i = 0; i < size; ++i) {
+    out[i] = (out[i] * 0.5f + 0.5f) * Amplitude;
+  }
+
+  // Chain rule of the mapping and of the noise coords (world / totalFreq)
+  if (outDX) {
+    const float slopeScale = (float)(0.5 * Amplitude / totalFreq);
+    for (int i = 0; i < size; ++i) {
+      outDX[i] *= slopeScale;
+      outDY[i] *= slopeScale;
+    }
+  }
+}
+
+bool FTG_GenerationParams::HasAnalyticNormals() const {
+  return analyticNormals && !noiseProgram.IsValid();
+}
+
+// Sampled maximum of the noise (before Amplitude and HeightRange), by the hash of the noise settings
+static FCriticalSection GMaxNoiseLock;
+static TMap<uint64, float> GMaxNoiseCache;
+
+float FTG_GenerationParams::ComputeMaxHeight() const {
+  // Only the noise changes the sampling, the scale is applied after
+  uint64 noiseKey;
+  {
+    TArray<uint8> bytes;
+    FMemoryWriter Ar(bytes);
+    int32 octaves = Octaves;
+    uint32 permutation = perlinNoiseTerrain.GetPermutationHash();
+    uint64 graph = noiseProgram.IsValid() ? noiseProgram->GetHash() : 0;
+    Ar << octaves << permutation << graph;
+    noiseKey = CityHash64((const char*)bytes.GetData(), bytes.Num());
+  }
+
+  {
+    FScopeLock ScopeLock(&GMaxNoiseLock);
+    if (const float* cached = GMaxNoiseCache.Find(noiseKey)) {
+      return *cached * Amplitude * tileSettings.getHeightRange();
+    }
+  }
+
+  // The noise repeats every 256 lattice units, so one period covers the whole world.
+  // Every octave k samples at 2^k times the position, so a rational step would put the higher
+  // octaves on the lattice (where the noise is always 0). 1/golden ratio never lines up with it.
+  const double SampleStep = 0.6180339887498949;
+  const double SampleOffset = 0.1415926535897932;
+  const int PeriodSamples = FMath::CeilToInt(256.0 / SampleStep);
+
+  // A graph is not periodic in general (frequencies, warps), the same window is an estimate
+  TArray<float> rowMax;
+  rowMax.SetNumZeroed(PeriodSamples);
+  ParallelFor(PeriodSamples, [&](int32 y) {
+    TArray<float> row;
+    row.SetNumUninitialized(PeriodSamples);
+    if (noiseProgram.IsValid()) {
+      noiseProgram->EvaluateGrid(SampleOffset, SampleOffset + y * SampleStep, SampleStep, PeriodSamples, 1, row.GetData());
+    }
+    else {
+      perlinNoiseTerrain.FillHeightGrid(SampleOffset, SampleOffset + y * SampleStep, SampleStep, PeriodSamples, 1, Octaves, row.GetData());
+    }
+    float value = 0.f;
+    for (int x = 0; x < PeriodSamples; ++x) {
+      value = FMath::Max(value, row[x]);
+    }
+    rowMax[y] = value;
+  });
+
+  float maxValue = 0.f;
+  for (float value : rowMax) {
+    maxValue = FMath::Max(maxValue, value);
+  }
+
+  // Same mapping as GetAlgorithmGrid and ScaleZWithHeightRange
+  if (!noiseProgram.IsValid()) {
+    maxValue = maxValue * 0.5f + 0.5f;
+  }
+
+  {
+    FScopeLock ScopeLock(&GMaxNoiseLock);
+    GMaxNoiseCache.Add(noiseKey, maxValue);
+  }
+  return maxValue * Amplitude * tileSettings.getHeightRange();
+}
+
+uint64 FTG_GenerationParams::ComputeSettingsHash() const {
+  TArray<uint8> bytes;
+  FMemoryWriter Ar(bytes);
+
+  // Algorithm
+  int32 seed = Seed;
+  double amplitude = Amplitude;
+  double frequency = Frequency;
+  int32 octaves = Octaves;
+  uint32 permutation = perlinNoiseTerrain.GetPermutationHash();
+  float normalization = maxHeight;
+  uint64 graph = noiseProgram.IsValid() ? noiseProgram->GetHash() : 0;
+  Ar << seed << amplitude << frequency << octaves << permutation << normalization << graph;
+
+  // Tile (the levels of detail and the UVs are not stored, they are rebuilt)
+  FTileSettings tile = tileSettings;
+  uint8 tileScaleIn = (uint8)tile.TileScaleIn;
+  uint8 lodScale = (uint8)tile.LODScale;
+  uint8 heightScale = (uint8)tile.HeightScale;
+  uint8 format = (uint8)vertexFormat;
+  bool seamless = seamlessNormals;
+  bool analytic = HasAnalyticNormals();
+  Ar << tile.TileSize << tileScaleIn << tile.bOptimalLOD << tile.LevelOfDetail << lodScale;
+  Ar << tile.HeightRange << heightScale << tile.ArrayLineSize << format << seamless << analytic;
+
+  // Biomes
+  bool vertexColor = useVertexColor;
+  bool heightMap = useHeightMap;
+  bool assets = spawnAssets;
+  int32 numBiomes = biomeList.Num();
+  Ar << vertexColor << heightMap << assets << numBiomes;
+  for (const FTG_BiomeParams& biome : biomeList) {
+    FTG_BiomeParams copy = biome;
+    bool hasMesh = biome.asset.hasMesh;
+    Ar << copy.minHeight << copy.maxHeight << copy.vertexColors;
+    Ar << copy.asset.probability << copy.asset.randomRotation << copy.asset.randomScale << copy.asset.maxRandomScale << hasMesh;
+  }
+
+  return CityHash64((const char*)bytes.GetData(), bytes.Num());
+}
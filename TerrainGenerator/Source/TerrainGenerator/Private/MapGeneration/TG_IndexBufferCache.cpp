@@ -0,0 +1,57 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#include "TG_IndexBufferCache.h"
+#include "Misc/ScopeLock.h"
+
+FTG_IndexBufferCache& FTG_IndexBufferCache::Get()
+{
+  static FTG_IndexBufferCache Cache;
+  return Cache;
+}
+
+uint64 FTG_IndexBufferCache::MakeKey(int lodLineSize, const FTG_LODStitch& stitch)
+{
+  return ((uint64)(uint32)lodLineSize << 32)
+    | ((uint64)stitch.Edge[0] << 24)
+    | ((uint64)stitch.Edge[1] << 16)
+    | ((uint64)stitch.Edge[2] << 8)
+    | (uint64)stitch.Edge[3];
+}
+
+FTG_IndexBufferPtr FTG_IndexBufferCache::FindOrBuild(int lodLineSize, const FTG_LODStitch& stitch)
+{
+  uint64 key = MakeKey(lodLineSize, stitch);
+
+  FScopeLock ScopeLock(&Lock);
+
+  if (FTG_IndexBufferPtr* cached = Buffers.Find(key)) {
+    return *cached;
+  }
+
+  TSharedPtr<FTG_IndexBuffer, ESPMode::ThreadSafe> triangles = MakeShareable(new FTG_IndexBuffer());
+  FTG_TileLOD::BuildTriangles(lodLineSize, stitch, triangles->Indices);
+
+  // Converted once here, so a section with 16-bit indices only copies them
+  if (lodLineSize * lodLineSize <= 65536) {
+    triangles->Indices16.SetNumUninitialized(triangles->Indices.Num());
+    for (int i = 0; i < triangles->Indices.Num(); ++i) {
+      triangles->Indices16[i] = (uint16)triangles->Indices[i];
+    }
+  }
+
+  FTG_IndexBufferPtr buffer = triangles;
+  Buffers.Add(key, buffer);
+  return buffer;
+}
+
+int FTG_IndexBufferCache::Num()
+{
+  FScopeLock ScopeLock(&Lock);
+  return Buffers.Num();
+}
+
+void FTG_IndexBufferCache::Reset()
+{
+  FScopeLock ScopeLock(&Lock);
+  Buffers.Reset();
+}
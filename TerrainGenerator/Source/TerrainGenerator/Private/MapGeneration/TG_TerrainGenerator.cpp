@@ -1,11 +1,33 @@
 // Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
 
 #include "TG_TerrainGenerator.h"
-#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Misc/SlowTask.h"
+#include "Misc/Paths.h"
+#include "TG_TileCache.h"
+#include "TG_IndexBufferCache.h"
+#include "TG_Stats.h"
+#include "TG_TileEventLog.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogTerrainGenerator, Log, All);
 DEFINE_LOG_CATEGORY_STATIC(LogTileCreation, Log, All);
 
+DECLARE_CYCLE_STAT(TEXT("TG - Update Streaming"), STAT_TerrainGenerator_UpdateStreaming, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Evict Tiles"), STAT_TerrainGenerator_EvictTiles, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Dispatch Tiles"), STAT_TerrainGenerator_DispatchTiles, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Create Tile"), STAT_TerrainGenerator_CreateTile, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Commit Tiles"), STAT_TerrainGenerator_CommitTiles, STATGROUP_TerrainGenerator);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("TG - Queued Tiles"), STAT_TerrainGenerator_QueuedTiles, STATGROUP_TerrainGenerator);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("TG - In Flight Tiles"), STAT_TerrainGenerator_InFlightTiles, STATGROUP_TerrainGenerator);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("TG - Pending Commits"), STAT_TerrainGenerator_PendingCommits, STATGROUP_TerrainGenerator);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("TG - Committed Tiles"), STAT_TerrainGenerator_CommittedTiles, STATGROUP_TerrainGenerator);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("TG - Resident Tiles"), STAT_TerrainGenerator_ResidentTiles, STATGROUP_TerrainGenerator);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("TG - Pooled Tiles"), STAT_TerrainGenerator_PooledTiles, STATGROUP_TerrainGenerator);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("TG - Evicted Tiles"), STAT_TerrainGenerator_EvictedTiles, STATGROUP_TerrainGenerator);
+DECLARE_MEMORY_STAT(TEXT("TG - Resident Memory"), STAT_TerrainGenerator_ResidentMemory, STATGROUP_TerrainGenerator);
+DECLARE_MEMORY_STAT(TEXT("TG - Memory Per Tile"), STAT_TerrainGenerator_MemoryPerTile, STATGROUP_TerrainGenerator);
+
 ATG_TerrainGenerator::ATG_TerrainGenerator()
 {
  	PrimaryActorTick.bCanEverTick = true;
@@ -29,59 +51,59 @@ void ATG_TerrainGenerator::BeginPlay()
   }
 }
 
+void ATG_TerrainGenerator::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  // Wait for the Tiles in generation
+  TileScheduler.Stop();
+
+  Super::EndPlay(EndPlayReason);
+}
+
+bool ATG_TerrainGenerator::ShouldTickIfViewportsOnly() const
+{
+  // The PreBake Tiles are dispatched from the Tick in Editor
+  return usePreBake;
+}
+
 void ATG_TerrainGenerator::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-  // Endless Terrain
-  if (useRuntime && infiniteTerrain && player)
+  // Endless Terrain and levels of detail
+  if (useRuntime && player)
   {
     FVector2D currentTile = getPlayerTileCoord();
     if (GEngine) {
       //GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Red, FString::Printf(TEXT("%.1f  |  %.1f"), currentTile.X, currentTile.Y));
     }
 
-    // Set Visible to False the Current Tiles
-    for (ATG_Tile* tile : TileList) {
-      tile->SetVisibile(false);
-      tile->SetVisibileAsset(false);
-    }
-    TileList.Empty();
-
-    // Check if it's needed a new Tile
-    for (int yOffset = -tVisibleInViewDst; yOffset <= tVisibleInViewDst; yOffset++) {
-      for (int xOffset = -tVisibleInViewDst; xOffset <= tVisibleInViewDst; xOffset++) {
-        FVector2D viewedTileCoord = FVector2D(currentTile.X + xOffset, currentTile.Y + yOffset);
-
-        // Check if contains this tile
-        if (TileMap.Contains(viewedTileCoord)) {
-
-          // TODO: For now just update the Visibility option
-          TileMap[viewedTileCoord]->Update(viewedTileCoord.X, viewedTileCoord.Y);
-
-          // If the Tile is Visible save for next frame
-          if (TileMap[viewedTileCoord]->Visible) {
-            TileList.Add(TileMap[viewedTileCoord]);
-          }
-          /*
-          // If is not visible and DestroyTilesOutOfRange is true DESTROY
-          else if(true == DestroyTilesOutOfRange){
-            // Destroy the Tile
-            if (true == TileMap[viewedTileCoord]->DestroyTile()) {
-              // Remove the Tile from the TMap
-              TileMap.Remove(viewedTileCoord);
-            }
-          }
-          */
-        }
-        else {
-          // For now Create a new one
-          CreateTile(viewedTileCoord.X, viewedTileCoord.Y);
-        }
-      }
+    // Only when the player enters another Tile
+    if (!streamingStarted || currentTile != streamingCenter) {
+      UpdateStreaming(currentTile);
     }
+  }
+
+  // Start the queued Tiles
+  DispatchTiles();
+
+  // Apply the finished ones
+  CommitTiles();
+
+  SET_DWORD_STAT(STAT_TerrainGenerator_QueuedTiles, TileScheduler.NumQueued());
+  SET_DWORD_STAT(STAT_TerrainGenerator_InFlightTiles, TileScheduler.NumInFlight());
+  SET_DWORD_STAT(STAT_TerrainGenerator_PendingCommits, TileScheduler.NumPendingCommits());
+  SET_DWORD_STAT(STAT_TerrainGenerator_ResidentTiles, TileMap.Num());
+  SET_DWORD_STAT(STAT_TerrainGenerator_PooledTiles, TilePool.Num());
 
+#if STATS
+  // In every mode, EvictTiles only runs with the streaming
+  SIZE_T residentBytes = 0;
+  for (const auto& tile : TileMap) {
+    residentBytes += tile.Value->GetResidentBytes();
   }
+  SET_MEMORY_STAT(STAT_TerrainGenerator_ResidentMemory, residentBytes);
+  SET_MEMORY_STAT(STAT_TerrainGenerator_MemoryPerTile, TileMap.Num() > 0 ? residentBytes / TileMap.Num() : 0);
+#endif
 }
 
 #if WITH_EDITOR
@@ -127,7 +149,10 @@ void ATG_TerrainGenerator::PostEditChangeProperty(struct FPropertyChangedEvent&
     if (CreateWorld) {
       CreateWorld = !CreateWorld;
 
-      if (false == generated)
+      if (bakeWorldPack) {
+        BakeWorldPack();
+      }
+      else if (false == generated)
       {
         CreateTerrain();
       }
@@ -162,37 +187,55 @@ void ATG_TerrainGenerator::CreateTerrain()
   // Initialize the Algorithm selected
   InitAlgorithm();
 
+  // Workers for the Tiles
+  TileScheduler.Start(generationWorkers);
+
   //Loop
   for (int x = -(numberOfTiles / 2); x <= (numberOfTiles / 2); ++x) {
     for (int y = -(numberOfTiles / 2); y <= (numberOfTiles / 2); ++y) {
-      // Create new Tile
-      CreateTile(x, y);     
+      // Queue new Tile
+      QueueTile(x, y);
     }
   }
 
+  // Start the first ones now
+  DispatchTiles();
+
   generated = true;
 }
 
 void ATG_TerrainGenerator::CreateTile(int x, int y) {
-  UE_LOG(LogTerrainGenerator, Log, TEXT("Create the Tile [%d, %d]"), x, y);
-  
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_CreateTile);
   // Set the Coordinates
    FVector position = FVector( x * tileSettings.getTileSize(), y * tileSettings.getTileSize(), 0.f );
 
-  // Spawn the Tile
-  ATG_Tile* tile = GetWorld()->SpawnActor<ATG_Tile>(position, FRotator::ZeroRotator);
+  ATG_Tile* tile = nullptr;
+  int newTileId = 0;
 
-#if WITH_EDITOR
-  if (TilePath != TEXT("")) {
-    tile->SetFolderPath(TilePath);
+  if (TilePool.Num() > 0) {
+    // Reuse a released Tile, it keeps its ID
+    tile = TilePool.Pop(false);
+    tile->SetTileWorldPosition(x, y, tileSettings);
+    newTileId = tile->TileID;
   }
+  else {
+    // Spawn the Tile
+    tile = GetWorld()->SpawnActor<ATG_Tile>(position, FRotator::ZeroRotator);
+
+#if WITH_EDITOR
+    if (TilePath != TEXT("")) {
+      tile->SetFolderPath(TilePath);
+    }
 #endif
 
-  // ID
-  int newTileId = TileMap.Num();
+    // ID
+    newTileId = nextTileId++;
+  }
+  tile->LastUsed = streamingEpoch;
+  TG_TILE_EVENT(Create, newTileId, x, y, 0);
 
-  // Initialize the Tile
-  auto future = Async<void>(EAsyncExecution::Thread, [&]() { tile->Init(newTileId, x, y, tileSettings, this); }, [&] { /* Callback */ });
+  // Initialize the Tile on a worker
+  LaunchTile(tile, newTileId, x, y);
 
   // Save the Tile
   TileMap.Add(FVector2D(x, y), tile);
@@ -214,15 +257,283 @@ void ATG_TerrainGenerator::UpdateTerrain() {
   // Initialize the Algorithm selected
   InitAlgorithm();
 
+  // Workers for the Tiles
+  TileScheduler.Start(generationWorkers);
+
   for (auto tile : TileMap) {
-    // Initialize the Tile
-    auto future = Async<void>(EAsyncExecution::Thread, [&]() { tile.Value->Init(tile.Value->TileID, tile.Value->TileX, tile.Value->TileY, tileSettings, this); }, [&] { /* Callback */ });
+    // Queue the Tile again
+    TileScheduler.Enqueue(tile.Key, tile.Value);
+  }
+
+  DispatchTiles();
+}
+
+void ATG_TerrainGenerator::UpdateStreaming(FVector2D currentTile) {
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_UpdateStreaming);
+  TG_TRACE_SCOPE(TG_UpdateStreaming);
+
+  streamingCenter = currentTile;
+  streamingStarted = true;
+  streamingEpoch++;
+
+  // Fixed terrain: only the levels of detail change
+  if (!infiniteTerrain) {
+    for (auto tile : TileMap) {
+      tile.Value->Update(tile.Key.X, tile.Key.Y);
+    }
+    return;
+  }
+
+  TSet<FVector2D> newWindow;
+  newWindow.Reserve((2 * tVisibleInViewDst + 1) * (2 * tVisibleInViewDst + 1));
+
+  // Check if it's needed a new Tile
+  for (int yOffset = -tVisibleInViewDst; yOffset <= tVisibleInViewDst; yOffset++) {
+    for (int xOffset = -tVisibleInViewDst; xOffset <= tVisibleInViewDst; xOffset++) {
+      FVector2D viewedTileCoord = FVector2D(currentTile.X + xOffset, currentTile.Y + yOffset);
+      newWindow.Add(viewedTileCoord);
+
+      // Check if contains this tile
+      if (ATG_Tile** tile = TileMap.Find(viewedTileCoord)) {
+        (*tile)->LastUsed = streamingEpoch;
+        (*tile)->Update(viewedTileCoord.X, viewedTileCoord.Y);
+      }
+      else {
+        // Queue a new one
+        QueueTile(viewedTileCoord.X, viewedTileCoord.Y);
+      }
+    }
+  }
+
+  // Hide the Tiles that left the window
+  for (const FVector2D& coord : StreamingWindow) {
+    if (!newWindow.Contains(coord)) {
+      if (ATG_Tile** tile = TileMap.Find(coord)) {
+        (*tile)->UpdateVisibility(false, false);
+      }
+    }
+  }
+
+  StreamingWindow = MoveTemp(newWindow);
+
+  // Keep the memory bounded while exploring
+  EvictTiles();
+}
+
+void ATG_TerrainGenerator::EvictTiles() {
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_EvictTiles);
+  int maxTiles = maxResidentTiles > 0 ? maxResidentTiles : 2 * StreamingWindow.Num();
+  SIZE_T maxBytes = (SIZE_T)maxResidentMemoryMB * 1024 * 1024;
+
+  SIZE_T residentBytes = 0;
+  TArray<FVector2D> candidates;
+  for (auto tile : TileMap) {
+    residentBytes += tile.Value->GetResidentBytes();
+
+    // The Tiles in the window are never evicted
+    if (!StreamingWindow.Contains(tile.Key)) {
+      candidates.Add(tile.Key);
+    }
+  }
+
+  int residentTiles = TileMap.Num();
+
+  if (residentTiles <= maxTiles && (maxBytes == 0 || residentBytes <= maxBytes)) {
+    return;
+  }
+
+  // Least recently used first
+  candidates.Sort([this](const FVector2D& A, const FVector2D& B) {
+    return TileMap[A]->LastUsed < TileMap[B]->LastUsed;
+  });
+
+  for (const FVector2D& coord : candidates) {
+    if (residentTiles <= maxTiles && (maxBytes == 0 || residentBytes <= maxBytes)) {
+      break;
+    }
+
+    ATG_Tile* tile = TileMap.FindAndRemoveChecked(coord);
+    TG_TILE_EVENT(Evict, tile->TileID, coord.X, coord.Y, tile->LastUsed);
+
+    residentBytes -= FMath::Min(residentBytes, tile->GetResidentBytes());
+    residentTiles--;
+    INC_DWORD_STAT(STAT_TerrainGenerator_EvictedTiles);
+
+    // Drop a pending regeneration and keep the actor for new coords
+    TileScheduler.Cancel(coord);
+    tile->ReleaseTile();
+    TilePool.Add(tile);
+  }
+}
+
+void ATG_TerrainGenerator::GetTileVisibility(int x, int y, bool& terrain, bool& assets) {
+  terrain = true;
+  assets = true;
+
+  // Without streaming every Tile is visible
+  if (!(useRuntime && infiniteTerrain) || !streamingStarted) {
+    return;
+  }
+
+  float distance = FVector2D::Distance(FVector2D(x, y), streamingCenter) * tileSettings.getTileSize();
+  terrain = distance <= maxViewDistance;
+  assets = terrain && distance <= maxViewDistance / numReducesMaxViewDistAssets;
+}
+
+int ATG_TerrainGenerator::GetLODForCoords(int x, int y) {
+  int numLODs = FMath::Min(tileSettings.NumLODs, FTG_TileLOD::MaxLODs);
+  if (!streamingStarted || numLODs <= 1) {
+    return 0;
+  }
+
+  // The Tiles next to the player always use the full resolution
+  float distance = FMath::Max(FVector2D::Distance(FVector2D(x, y), streamingCenter) - 1.f, 0.f) * tileSettings.getTileSize();
+  int lod = FMath::FloorToInt(distance / tileSettings.getLODDistance());
+
+  return FMath::Clamp(lod, 0, numLODs - 1);
+}
+
+void ATG_TerrainGenerator::GetTileLOD(int x, int y, int& lod, FTG_LODStitch& stitch) {
+  lod = GetLODForCoords(x, y);
+
+  // Neighbours in the order of the edges: (y = 0), (x = last), (y = last), (x = 0)
+  static const int neighbourX[4] = { 0, 1, 0, -1 };
+  static const int neighbourY[4] = { -1, 0, 1, 0 };
+  for (int edge = 0; edge < 4; ++edge) {
+    int neighbourLOD = GetLODForCoords(x + neighbourX[edge], y + neighbourY[edge]);
+    stitch.Edge[edge] = (uint8)FMath::Max(neighbourLOD - lod, 0);
+  }
+}
+
+void ATG_TerrainGenerator::QueueTile(int x, int y) {
+  TileScheduler.Enqueue(FVector2D(x, y));
+}
+
+void ATG_TerrainGenerator::DispatchTiles() {
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_DispatchTiles);
+  if (TileScheduler.NumQueued() == 0) {
+    return;
+  }
+
+  // In Infinite mode the Tiles that left the view range before starting are cancelled
+  FVector2D center = player ? getPlayerTileCoord() : FVector2D::ZeroVector;
+  int cancelRange = (useRuntime && infiniteTerrain) ? tVisibleInViewDst : -1;
+
+  TArray<FTG_TileJob> admitted;
+  TileScheduler.Update(center, cancelRange, maxTilesPerFrame, admitted);
+
+  for (const FTG_TileJob& job : admitted) {
+    if (job.tile) {
+      // Regenerate an existing Tile
+      LaunchTile(job.tile, job.tile->TileID, job.tile->TileX, job.tile->TileY);
+    }
+    else {
+      CreateTile(job.coord.X, job.coord.Y);
+    }
   }
 }
 
+void ATG_TerrainGenerator::CommitTiles() {
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_CommitTiles);
+  FVector2D center = streamingStarted ? streamingCenter : FVector2D::ZeroVector;
+
+  int committed = TileScheduler.Commit(center, commitBudgetMs / 1000.0);
+  SET_DWORD_STAT(STAT_TerrainGenerator_CommittedTiles, committed);
+}
+
+void ATG_TerrainGenerator::LaunchTile(ATG_Tile* tile, int tileID, int x, int y) {
+  if (!GenerationParams.IsValid()) {
+    InitAlgorithm();
+  }
+
+  TWeakObjectPtr<ATG_Tile> weakTile = tile;
+  TWeakObjectPtr<ATG_TerrainGenerator> weakManager = this;
+  FTG_GenerationParamsPtr params = GenerationParams;
+
+  TileScheduler.Start(generationWorkers);
+  uint32 serial = ++tile->BuildSerial;
+
+  // The scheduler outlives its workers (Stop waits for them)
+  FTG_TileScheduler* scheduler = &TileScheduler;
+  TileScheduler.Launch([scheduler, weakTile, weakManager, params, serial, tileID, x, y]() {
+    // Worker: only reads the snapshot and writes the result
+    TSharedPtr<FTG_TileBuildResult, ESPMode::ThreadSafe> result = MakeShareable(new FTG_TileBuildResult());
+    result->Params = params;
+    FTG_TileBuilder(*params, *result).Build(tileID, x, y);
+
+    // Game thread: apply everything at once when there is commit budget
+    scheduler->Complete(FVector2D(x, y), [weakTile, weakManager, result, serial]() {
+      // Skip if the Tile was released or relaunched meanwhile
+      if (weakTile.IsValid() && weakManager.IsValid() && weakTile->BuildSerial == serial) {
+        weakTile->Commit(*result, weakManager.Get());
+      }
+    });
+  });
+}
+
+FString ATG_TerrainGenerator::GetWorldPackPath() const {
+  return FPaths::ProjectContentDir() / worldPackFile;
+}
+
+bool ATG_TerrainGenerator::BakeWorldPack() {
+  UE_LOG(LogTerrainGenerator, Log, TEXT("Bake the World Pack"));
+  double startTime = FPlatformTime::Seconds();
+
+  // Same settings as CreateTerrain
+  tileSettings.Init();
+  InitAlgorithm();
+
+  // The baked Tiles are always generated
+  FTG_GenerationParams params = *GenerationParams;
+  params.useTileCache = false;
+  params.worldPack.Reset();
+
+  // The file can not be replaced while it is open
+  WorldPack.Reset();
+
+  int half = numberOfTiles / 2;
+  int side = 2 * half + 1;
+
+  FTG_WorldPackWriter writer;
+  if (!writer.Open(GetWorldPackPath(), params, side * side)) {
+    return false;
+  }
+
+  FScopedSlowTask task(side, FText::FromString(TEXT("Baking the World Pack")));
+  task.MakeDialog();
+
+  // One row of Tiles at a time on all the cores, written in order so the same settings give the same file
+  TArray<TArray<uint8>> chunks;
+  for (int y = -half; y <= half; ++y) {
+    task.EnterProgressFrame();
+
+    chunks.Reset();
+    chunks.SetNum(side);
+    ParallelFor(side, [&params, &chunks, half, y](int32 index) {
+      int x = index - half;
+
+      FTG_TileBuildResult result;
+      FTG_TileBuilder(params, result).Build(-1, x, y);
+
+      FTG_TileCache::WriteChunk(params, *result.LODMeshes[0], result, chunks[index]);
+    });
+
+    for (int index = 0; index < side; ++index) {
+      writer.AddTile(index - half, y, chunks[index]);
+    }
+  }
+
+  bool success = writer.Close();
+  UE_LOG(LogTerrainGenerator, Log, TEXT("Baked %d Tiles in %.2f s"), writer.NumTiles(), FPlatformTime::Seconds() - startTime);
+  return success;
+}
+
 void ATG_TerrainGenerator::DestroyTerrain()
 {
   UE_LOG(LogTerrainGenerator, Log, TEXT("Destroy all the Terrain Tiles"));
+  // Drop the queued Tiles and wait for the ones in generation
+  TileScheduler.Stop();
+
   // If Tiles exist
   if (TileMap.Num() > 0) {
     for (auto tile : TileMap)
@@ -232,6 +543,17 @@ void ATG_TerrainGenerator::DestroyTerrain()
     TileMap.Empty();
   }
 
+  // Destroy the released Tiles
+  for (ATG_Tile* tile : TilePool) {
+    tile->DestroyTile();
+  }
+  TilePool.Empty();
+  nextTileId = 0;
+
+  // Reset the streaming window
+  StreamingWindow.Empty();
+  streamingStarted = false;
+
   generated = false;
 }
 
@@ -249,13 +571,96 @@ void ATG_TerrainGenerator::InitAlgorithm() {
     // Initialize the Biomes Perlin Noise
     perlinNoiseBiomes.setNoiseSeed(Seed + 1);
   }
+
+  // The grids of the previous settings are not needed anymore (the live Tiles keep theirs)
+  FTG_IndexBufferCache::Get().Reset();
+  FTG_VertexTemplateCache::Get().Reset();
+
+  // Settings for the Tiles generated from now on
+  GenerationParams = BuildGenerationParams();
+}
+
+FTG_GenerationParamsPtr ATG_TerrainGenerator::BuildGenerationParams() {
+  TSharedPtr<FTG_GenerationParams, ESPMode::ThreadSafe> params = FTG_GenerationParams::Allocate();
+
+  // Algorithm
+  params->Seed = Seed;
+  params->Amplitude = Amplitude;
+  params->Frequency = Frequency;
+  params->Octaves = Octaves;
+  params->perlinNoiseTerrain = perlinNoiseTerrain;
+  if (useNoiseGraph) {
+    FString error;
+    params->noiseProgram = FTG_NoiseProgram::Compile(noiseGraph, Seed, error);
+    if (!params->noiseProgram.IsValid()) {
+      UE_LOG(LogTerrainGenerator, Warning, TEXT("The Noise Graph is not valid, the Perlin terrain is used: %s"), *error);
+    }
+  }
+
+  // Tile
+  params->tileSettings = tileSettings;
+  params->vertexTemplate = FTG_VertexTemplateCache::Get().FindOrBuild(
+    tileSettings.getArrayLineSize(), tileSettings.getLOD(), tileSettings.TextureScale);
+  params->seamlessNormals = seamlessNormals;
+  params->analyticNormals = analyticNormals;
+  params->vertexFormat = vertexFormat;
+  params->useTileCache = useTileCache;
+  params->TileName = TileName;
+  params->maxDistanceForAssets = maxViewDistance / numReducesMaxViewDistAssets;
+
+  // Biomes
+  params->useVertexColor = useVertexColor;
+  params->useHeightMap = useHeightMap;
+  params->spawnAssets = spawnAssets;
+  params->biomeList.Reset(biomeList.Num());
+  for (const FBiomeSettings& biome : biomeList) {
+    params->biomeList.Emplace(biome);
+  }
+  params->defaultMaterial = defaultMaterial;
+
+  // Water
+  params->useWater = useWater;
+  params->waterHeight = waterHeight;
+  params->water = water;
+  params->waterMaterial = waterMaterial;
+
+  // Normalization shared by every Tile of this Seed
+  params->maxHeight = params->ComputeMaxHeight();
+  maxHeight = params->maxHeight;
+
+  // Key of the Tile Cache, after maxHeight which is part of it
+  params->SettingsHash = params->ComputeSettingsHash();
+
+  // Baked Tiles, only when they were baked with the same settings
+  if (useRuntime && useWorldPack) {
+    FString packPath = GetWorldPackPath();
+    if (!WorldPack.IsValid() || WorldPack->GetPath() != packPath) {
+      WorldPack = FTG_WorldPack::Open(packPath);
+    }
+    if (WorldPack.IsValid() && WorldPack->GetSettingsHash() == params->SettingsHash) {
+      params->worldPack = WorldPack;
+    }
+    else if (WorldPack.IsValid()) {
+      UE_LOG(LogTerrainGenerator, Warning, TEXT("The World Pack %s was baked with other settings, the Tiles are generated"), *packPath);
+    }
+  }
+  else {
+    WorldPack.Reset();
+  }
+
+  return params;
 }
 
 double ATG_TerrainGenerator::GetAlgorithmValue(double x, double y) {
   double value = 0.0;
 
   double totalFreq = Frequency * tileSettings.getTileSize();
-  value += perlinNoiseTerrain.octaveNoise0_1(x / totalFreq, y / totalFreq, 0.0, Octaves);
+  if (GenerationParams.IsValid() && GenerationParams->noiseProgram.IsValid()) {
+    value += GenerationParams->noiseProgram->Evaluate(x / totalFreq, y / totalFreq);
+  }
+  else {
+    value += perlinNoiseTerrain.octaveNoise0_1(x / totalFreq, y / totalFreq, 0.0, Octaves);
+  }
   
   //Apply the Amplitude to the results
   value *= Amplitude;
@@ -264,16 +669,7 @@ double ATG_TerrainGenerator::GetAlgorithmValue(double x, double y) {
 }
 
 double ATG_TerrainGenerator::GetSpecifiedAlgorithmValue(PerlinType type, double x, double y, double amplitude, double frequency, int octaves) {
-  TG_PerlinNoise perlinAlgorithm;
-
-  switch (type) {
-  case PerlinType::Perlin_Terrain:
-    perlinAlgorithm = perlinNoiseTerrain;
-    break;
-  case PerlinType::Perlin_Biome:
-    perlinAlgorithm = perlinNoiseBiomes;
-    break;
-  }
+  const TG_PerlinNoise<float>& perlinAlgorithm = type == PerlinType::Perlin_Biome ? perlinNoiseBiomes : perlinNoiseTerrain;
 
   double value = 0.0;
   double totalFreq = frequency * tileSettings.getTileSize();
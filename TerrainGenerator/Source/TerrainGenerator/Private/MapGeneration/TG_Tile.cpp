@@ -2,24 +2,35 @@
 
 #include "TG_Tile.h"
 #include "TG_TerrainGenerator.h"
+#include "TG_Stats.h"
+#include "TG_TileEventLog.h"
 
-#include "RuntimeMeshLibrary.h"
-
-DEFINE_LOG_CATEGORY_STATIC(LogTile, Log, All);
 DEFINE_LOG_CATEGORY_STATIC(LogTileAsync, Log, All);
 
+DECLARE_CYCLE_STAT(TEXT("TG - Commit Tile"), STAT_TerrainGenerator_CommitTile, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Commit Tile - Mesh"), STAT_TerrainGenerator_CommitMesh, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Commit Tile - Mesh Section"), STAT_TerrainGenerator_CommitMeshSection, STATGROUP_TerrainGenerator);
+// Only the section that queues the collision, the cook itself is "RM - Collision Update" and
+// "RM - Async Collision Cook Finish" of STATGROUP_RuntimeMesh
+DECLARE_CYCLE_STAT(TEXT("TG - Commit Tile - Mesh Section Queue Collision"), STAT_TerrainGenerator_CommitMeshCollision, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Commit Tile - Water"), STAT_TerrainGenerator_CommitWater, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Commit Tile - Assets"), STAT_TerrainGenerator_CommitAssets, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Apply LOD"), STAT_TerrainGenerator_ApplyLOD, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Visibility"), STAT_TerrainGenerator_Visibility, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Release Tile"), STAT_TerrainGenerator_ReleaseTile, STATGROUP_TerrainGenerator);
+
 // Sets default values
 ATG_Tile::ATG_Tile()
 {
-  // Root
+  // Root (Movable, the pooled Tiles move to new coords)
   USceneComponent* root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
-  root->SetMobility(EComponentMobility::Static);
+  root->SetMobility(EComponentMobility::Movable);
   RootComponent = root;
 
   // Terrain
   RuntimeMesh = CreateDefaultSubobject<URuntimeMeshComponent>(TEXT("RuntimeMeshC"));
   RuntimeMesh->SetupAttachment(RootComponent);
-  RuntimeMesh->SetMobility(EComponentMobility::Static);
+  RuntimeMesh->SetMobility(EComponentMobility::Movable);
 
   // Water
   waterComponent = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("WaterC"));
@@ -52,77 +63,117 @@ ATG_Tile::ATG_Tile()
 
 }
 
-// Sets default values
-void ATG_Tile::Init(int tileID, int coordX, int coordY, FTileSettings tSettings, ATG_TerrainGenerator* manager)
+// Apply a Tile generated by a worker
+void ATG_Tile::Commit(FTG_TileBuildResult& result, ATG_TerrainGenerator* manager)
 {
-  UE_LOG(LogTile, Log, TEXT("TILE[%d] Init Tile"), tileID, coordX, coordY);
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_CommitTile);
+  TG_TRACE_SCOPE(TG_CommitTile);
+
+  // Build time in microseconds
+  TG_TILE_EVENT(Commit, result.TileID, result.TileX, result.TileY, (uint32)(result.Timings.Total() * 1e6));
   // The Manager
   TerrainGenerator = manager;
+  GenerationParams = result.Params;
 
   // Tile Info
-  TileID = tileID;
-  TileSeed = manager->Seed * coordX + coordY;
-  TileX = coordX;
-  TileY = coordY;
-  tileSettings = tSettings;
-
-  maxDistanceForAssets = TerrainGenerator->maxViewDistance / TerrainGenerator->numReducesMaxViewDistAssets;
- 
-  // Set the Name of the Tile
-  AsyncTask(ENamedThreads::GameThread, [&]() { setTileName(TerrainGenerator->TileName); });
-  
-  // Initialize the values to default
-  InitMeshToCreate();
+  TileID = result.TileID;
+  TileSeed = GenerationParams->Seed * result.TileX + result.TileY;
+  TileX = result.TileX;
+  TileY = result.TileY;
+  tileSettings = GenerationParams->tileSettings;
+
+  maxDistanceForAssets = GenerationParams->maxDistanceForAssets;
+
+  // Take the generated buffers
+  PendingLODs = MoveTemp(result.LODMeshes);
+
+  // The sections can't change their stream layout, recreate them if the vertex format changed
+  if (PendingLODs.Num() > 0) {
+    const FRuntimeMeshBuilder& mesh = *PendingLODs[0];
+    uint8 format = (mesh.IsUsingHighPrecisionUVs() ? 1 : 0)
+      | (mesh.IsUsing32BitIndices() ? 2 : 0)
+      | (PendingLODs[0]->GetColorStream().Num() > 0 ? 4 : 0);
+    if (Generated && format != SectionsFormat) {
+      RuntimeMesh->ClearAllMeshSections();
+      Generated = false;
+    }
+    SectionsFormat = format;
+  }
+  HeightField = MoveTemp(result.HeightField);
 
-  // Generate everything
-  GenerateTriangles();
-  GenerateVertices();
-  GenerateNormalTangents(false);
+  // Set the Name of the Tile
+  setTileName(GenerationParams->TileName);
 
   // Set Water
-  AsyncTask(ENamedThreads::GameThread, [&]() { SetupWater(tileSettings); });
-
-  // Set the Biomes
-  AsyncTask(ENamedThreads::GameThread, [&]() { SetupBiomes(tileSettings); });
+  SetupWater(tileSettings);
 
   // Set the Assets
-  AsyncTask(ENamedThreads::GameThread, [&]() { SetupAssets(tileSettings); });
+  SetupAssets(result.AssetTransforms);
 
-  if (Generated == false)
-  {
-    // Create the Mesh
-    AsyncTask(ENamedThreads::GameThread, [&]() { GenerateMesh(TerrainGenerator->defaultMaterial); });
-  }
-  else
-  {
-    // Update the Mesh
-    AsyncTask(ENamedThreads::GameThread, [&]() { UpdateMesh(TerrainGenerator->defaultMaterial); });
-  }
+  // The sections have the previous mesh, they are rebuilt when shown
+  LODSectionsBuilt = 0;
+  CurrentLOD = -1;
 
-  // Set Tile is Visible
-  AsyncTask(ENamedThreads::GameThread, [&]() { SetVisibile(true); });
-  AsyncTask(ENamedThreads::GameThread, [&]() { SetVisibileAsset(true); });
+  // Set Tile is Visible (unless it left the streaming window meanwhile) and build its level of detail
+  Update(TileX, TileY);
 }
 
 void ATG_Tile::Update(int coordX, int coordY) {
   if (TerrainGenerator) {
     // Calculate if this Tile is Visible or Not
-    FVector viewer = TerrainGenerator->player->GetActorLocation();
-    viewer.Z = 0.f;
-
-    float viewerDstFromNearestEdge = FVector::Dist2D(this->GetActorLocation(), viewer);
+    bool vTerrainWater = false;
+    bool vAssets = false;
+    TerrainGenerator->GetTileVisibility(coordX, coordY, vTerrainWater, vAssets);
 
-    // The Tile (Terrain & Water)
-    bool vTerrainWater = viewerDstFromNearestEdge <= TerrainGenerator->maxViewDistance;
-    SetVisibile(vTerrainWater);
+    UpdateVisibility(vTerrainWater, vAssets);
 
-    // If the Tile exist set the visibility of the assets
+    // Hidden Tiles keep their level until they are visible again
     if (vTerrainWater) {
-      if (viewerDstFromNearestEdge <= maxDistanceForAssets) {
-        SetVisibileAsset(true);
-      }
+      int lod = 0;
+      FTG_LODStitch stitch;
+      TerrainGenerator->GetTileLOD(coordX, coordY, lod, stitch);
+      ApplyLOD(lod, stitch);
+    }
+  }
+}
+
+void ATG_Tile::ApplyLOD(int lod, const FTG_LODStitch& stitch) {
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_ApplyLOD);
+  lod = FMath::Clamp(lod, 0, FTG_TileLOD::MaxLODs - 1);
+
+  // Nothing generated for this level
+  bool built = (LODSectionsBuilt & (1u << lod)) != 0;
+  if (!built && !(lod < PendingLODs.Num() && PendingLODs[lod].IsValid())) {
+    return;
+  }
+  if (built && lod == CurrentLOD && stitch == CurrentStitch) {
+    return;
+  }
+
+  if (!built || stitch != LODStitches[lod]) {
+    GenerateMesh(lod, stitch);
+  }
+
+  // Only one level visible
+  for (int i = 0; i < FTG_TileLOD::MaxLODs; ++i) {
+    if (RuntimeMesh->DoesSectionExist(i)) {
+      RuntimeMesh->SetMeshSectionVisible(i, i == lod);
     }
   }
+
+  CurrentLOD = lod;
+  CurrentStitch = stitch;
+}
+
+void ATG_Tile::UpdateVisibility(bool terrain, bool assets) {
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_Visibility);
+  // Only touch the components when the state changes
+  if (terrain != Visible) {
+    SetVisibile(terrain);
+  }
+  if (assets != VisibleAsset) {
+    SetVisibileAsset(assets);
+  }
 }
 
 bool ATG_Tile::DestroyTile() {
@@ -148,127 +199,81 @@ bool ATG_Tile::DestroyTile() {
   return Destroy(true);
 }
 
-void ATG_Tile::InitMeshToCreate()
+void ATG_Tile::GenerateMesh(int lod, const FTG_LODStitch& stitch)
 {
-  UE_LOG(LogTile, Log, TEXT("TILE[%d] Initialize Mesh Values"), TileID);
-  MeshToCreate.Vertices.Init(FVector(0.0, 0.0, 0.0), tileSettings.ArraySize);
-  MeshToCreate.Normals.Init(FVector(0, 0, 1), tileSettings.ArraySize);
-  MeshToCreate.Tangents.Init(FRuntimeMeshTangent(0, -1, 0), tileSettings.ArraySize);
-  MeshToCreate.UV.Init(FVector2D(0, 0), tileSettings.ArraySize);
-  MeshToCreate.VertexColors.Init(FColor::White, tileSettings.ArraySize);
-  int QuadSize = 6;
-  int NumberOfQuadsPerLine =  tileSettings.getArrayLineSize();
-  int TrianglesArraySize = NumberOfQuadsPerLine * NumberOfQuadsPerLine * QuadSize;
-  MeshToCreate.Triangles.Init(0, TrianglesArraySize);
-}
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_CommitMesh);
+  TG_TILE_STAGE_EVENT(CommitMesh, TileID, TileX, TileY, lod);
+  int lineSize = tileSettings.getArrayLineSize();
+  bool built = (LODSectionsBuilt & (1u << lod)) != 0;
+
+  // Triangles of the level, stitched to the coarser neighbours (shared by all the Tiles)
+  FTG_IndexBufferPtr sharedTriangles = FTG_IndexBufferCache::Get().FindOrBuild(FTG_TileLOD::GetLODLineSize(lineSize, lod), stitch);
+  const FTG_IndexBuffer& triangles = *sharedTriangles;
+
+  if (built) {
+    // Only the neighbours changed
+    RuntimeMesh->UpdateMeshSectionTriangles(lod, triangles.Indices);
+  }
+  else {
+    // The streams were packed by the worker, the section takes them without copying
+    TSharedPtr<FRuntimeMeshBuilder> mesh = PendingLODs[lod];
+    PendingLODs[lod].Reset();
+    if (mesh->IsUsing32BitIndices()) {
+      mesh->SetIndices(0, triangles.Indices, triangles.Indices.Num(), true);
+    }
+    else {
+      check(triangles.Indices16.Num() == triangles.Indices.Num());
+      mesh->SetIndices(0, triangles.Indices16, triangles.Indices16.Num(), true);
+    }
 
-void ATG_Tile::GenerateVertices()
-{
-  if (TerrainGenerator) {
-    UE_LOG(LogTile, Log, TEXT("TILE[%d] Generating Vertices"), TileID);
-
-    int NumberOfQuadsPerLine = tileSettings.getArrayLineSize();
-    for (int y = 0; y < NumberOfQuadsPerLine; y++) {
-      for (int x = 0; x < NumberOfQuadsPerLine; x++) {
-        FVector2D Position = GetVerticePosition(x, y);
-
-        double AlgorithmZ = GetNoiseValueForGridCoordinates(Position.X, Position.Y);
-
-        double ZPos = ScaleZWithHeightRange(AlgorithmZ);
-        FVector value = FVector(Position.X, Position.Y, ZPos);
-        int index = GetValueIndexForCoordinates(x, y);
-        // Set the Algorithm Value At X & Y coordinates
-        MeshToCreate.Vertices[GetValueIndexForCoordinates(x, y)] = value;
-        // Calculate the UV
-        MeshToCreate.UV[index] = CalculateUV(x, y);
-
-        // Save the Z Position
-        ZPositions.Add(FVector2D(x, y), ZPos);
-        // Save the Maximum Z Position
-        if (ZPos > TerrainGenerator->maxHeight) {
-          TerrainGenerator->maxHeight = ZPos;
-        }
+    // Measured before the section takes the streams
+    LODVertexBytes[lod] = mesh->GetPositionStream().Num() + mesh->GetTangentStream().Num()
+      + mesh->GetUVStream().Num() + mesh->GetColorStream().Num();
+    LODIndexSize[lod] = mesh->IsUsing32BitIndices() ? sizeof(int32) : sizeof(uint16);
 
-      }
+    // Collision only for the full resolution, cooked later by the RuntimeMesh
+    if (lod == 0) {
+      SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_CommitMeshCollision);
+      CommitSection(lod, mesh, true);
     }
-  }
-}
-
-void ATG_Tile::GenerateTriangles()
-{
-  UE_LOG(LogTile, Log, TEXT("TILE[%d] Generating Triangles"), TileID);
-  int QuadSize = 6;
-  int NumberOfQuadsPerLine = tileSettings.getArrayLineSize() - 1;
-
-  for (int y = 0; y < NumberOfQuadsPerLine; y++) {
-    for (int x = 0; x < NumberOfQuadsPerLine; x++) {
-      int QIndex = x + y * NumberOfQuadsPerLine;
-      int TIndex = QIndex * QuadSize;
-
-      int botLeft = GetValueIndexForCoordinates(x, y);
-      int topLeft = GetValueIndexForCoordinates(x, y + 1);
-      int topRight = GetValueIndexForCoordinates(x + 1, y + 1);
-      int botRight = GetValueIndexForCoordinates(x + 1, y);
-      MeshToCreate.Triangles[TIndex] = botLeft;
-      MeshToCreate.Triangles[TIndex + 1] = topLeft;
-      MeshToCreate.Triangles[TIndex + 2] = topRight;
-      MeshToCreate.Triangles[TIndex + 3] = botLeft;
-      MeshToCreate.Triangles[TIndex + 4] = topRight;
-      MeshToCreate.Triangles[TIndex + 5] = botRight;
+    else {
+      SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_CommitMeshSection);
+      CommitSection(lod, mesh, false);
     }
-  }
-}
 
-void ATG_Tile::GenerateNormalTangents(bool SmoothNormals) {
-  // Calculate Normals And Tangents
-  URuntimeMeshLibrary::CalculateTangentsForMesh(MeshToCreate.Vertices, MeshToCreate.Triangles, MeshToCreate.Normals,
-    MeshToCreate.UV, MeshToCreate.Tangents, SmoothNormals);
-}
+    RuntimeMesh->SetSectionMaterial(lod, GenerationParams->defaultMaterial.Get());
+  }
 
-void ATG_Tile::GenerateMesh(UMaterialInterface* material)
-{
-  UE_LOG(LogTile, Log, TEXT("TILE[%d] Generating Mesh"), TileID);
-  //RuntimeMesh->SetMaterial(TileID, material);
-  RuntimeMesh->CreateMeshSection(TileID,
-    MeshToCreate.Vertices,
-    MeshToCreate.Triangles,
-    MeshToCreate.Normals,
-    MeshToCreate.UV,
-    MeshToCreate.VertexColors,
-    MeshToCreate.Tangents,
-    true,
-    EUpdateFrequency::Infrequent,
-    ESectionUpdateFlags::None);
-
-  RuntimeMesh->SetSectionMaterial(TileID, material);
+  LODSectionsBuilt |= 1u << lod;
+  LODStitches[lod] = stitch;
+  LODTriangles[lod] = sharedTriangles;
 
   // Set Generated Tile to True
   Generated = true;
 }
 
-void ATG_Tile::UpdateMesh(UMaterialInterface* material)
+void ATG_Tile::CommitSection(int lod, TSharedPtr<FRuntimeMeshBuilder> mesh, bool collision)
 {
-  UE_LOG(LogTile, Log, TEXT("TILE[%d] Update Mesh"), TileID);
-  //RuntimeMesh->SetMaterial(TileID, material);
-
-  RuntimeMesh->UpdateMeshSection(TileID,
-    MeshToCreate.Vertices,
-    MeshToCreate.Triangles,
-    MeshToCreate.Normals,
-    MeshToCreate.UV,
-    MeshToCreate.VertexColors,
-    MeshToCreate.Tangents,
-    ESectionUpdateFlags::None);
-
-  RuntimeMesh->SetSectionMaterial(TileID, material);
+  if (RuntimeMesh->DoesSectionExist(lod)) {
+    RuntimeMesh->UpdateMeshSectionByMove(lod, mesh, ESectionUpdateFlags::None);
+  }
+  else {
+    // The section only queues the collision, the RuntimeMesh cooks it on a later tick. Cooked on a
+    // worker it stays out of the frame, so the commit budget of the scheduler covers the whole commit
+    if (collision) {
+      RuntimeMesh->SetCollisionUseAsyncCooking(true);
+    }
+    RuntimeMesh->CreateMeshSectionByMove(lod, mesh, collision, EUpdateFrequency::Infrequent, ESectionUpdateFlags::None);
+  }
 }
 
 void ATG_Tile::SetupWater(FTileSettings tSettings)
 {
-  if (TerrainGenerator) {
-    UE_LOG(LogTile, Log, TEXT("TILE[%d] Setup Water"), TileID);
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_CommitWater);
+  if (TerrainGenerator && GenerationParams.IsValid()) {
+    TG_TILE_STAGE_EVENT(CommitWater, TileID, TileX, TileY, 0);
     // If not use the water hide plane and disable collision JUST IN CASE
-    if (false == TerrainGenerator->useWater)
+    if (false == GenerationParams->useWater)
     {
       waterComponent->SetHiddenInGame(true);
       waterComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
@@ -276,13 +281,13 @@ void ATG_Tile::SetupWater(FTileSettings tSettings)
     }
 
     // Set the mesh to use
-    waterComponent->SetStaticMesh(TerrainGenerator->water);
+    waterComponent->SetStaticMesh(GenerationParams->water.Get());
 
     // Set the material for the water
-    waterComponent->SetMaterial(0, TerrainGenerator->waterMaterial);
+    waterComponent->SetMaterial(0, GenerationParams->waterMaterial.Get());
 
     // Height of the Water
-    float waterHeightPos = TerrainGenerator->maxHeight * TerrainGenerator->waterHeight;
+    float waterHeightPos = GenerationParams->maxHeight * GenerationParams->waterHeight;
     FVector waterPos = FVector(0.f, 0.f, waterHeightPos);
     waterComponent->SetRelativeLocation(waterPos);
 
@@ -300,144 +305,98 @@ void ATG_Tile::SetupWater(FTileSettings tSettings)
   }
 }
 
-void ATG_Tile::SetupBiomes(FTileSettings tSettings)
-{
-  if (TerrainGenerator) {
-    UE_LOG(LogTile, Log, TEXT("TILE[%d] Setup Biomes"), TileID);
-
-    if (TerrainGenerator->useVertexColor == true) {
-
-      // For each Biome
-      for (int indexBiome = 0; indexBiome < TerrainGenerator->biomeList.Num(); indexBiome++)
-      {
-        // Vertices
-        int i = 0;
-        for (auto Elem : ZPositions) {
-          // Get Perlin Value
-          float ZPos = Elem.Value / TerrainGenerator->maxHeight;
-
-          // Clamp
-          if (ZPos < 0.0f) { ZPos = 0.0f; }
-          else if (ZPos >= 1.0f) { ZPos = 1.f; }
-
-          // Set the VertexColor depend the Height
-          if (ZPos >= TerrainGenerator->biomeList[indexBiome].minHeight) {
-            if (ZPos <= TerrainGenerator->biomeList[indexBiome].maxHeight) {
-
-              // Select a random Color
-              int numberOfColors = TerrainGenerator->biomeList[indexBiome].vertexColors.Num() - 1;
-              int randomVertexColor = FMath::RandRange(0, numberOfColors);
-
-              // Set the Vertex Color
-              MeshToCreate.VertexColors[i] = TerrainGenerator->biomeList[indexBiome].vertexColors[randomVertexColor];
-            }
-          }
-          ++i;
-        }
-      }
+void ATG_Tile::SetupAssets(const TArray<TArray<FTransform>>& assetTransforms) {
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_CommitAssets);
+  if (TerrainGenerator && GenerationParams.IsValid()) {
+    TG_TILE_STAGE_EVENT(CommitAssets, TileID, TileX, TileY, assetTransforms.Num());
+
+    // Remove the instances of a previous generation
+    for (int i = 0; i < InstancedList.Num(); ++i) {
+      InstancedList[i]->ClearInstances();
     }
 
-    if (TerrainGenerator->useHeightMap == true) {
-      // Calculate the Height Map
-      for (int indexBiome = 0; indexBiome < TerrainGenerator->biomeList.Num(); indexBiome++)
-      {
-        FBiomeSettings lowerBiome;
-
-        // Vertices
-        int i = 0;
-        for (auto Elem : ZPositions) {
-          // Get Perlin Value
-          float ZPos = Elem.Value / TerrainGenerator->maxHeight;
-
-          float clamped = ZPos * 255;
-          if (clamped < 0.0f) {
-            clamped = 0.0f;
-          }
-
-          // Set the Vertex Color
-          MeshToCreate.VertexColors[i] = FColor(clamped, clamped, clamped);
-          ++i;
-        }
+    // For each Biome
+    for (int indexBiome = 0; indexBiome < assetTransforms.Num() && indexBiome < InstancedList.Num(); indexBiome++)
+    {
+      if (assetTransforms[indexBiome].Num() == 0) {
+        continue;
+      }
+      const FTG_AssetParams& asset = GenerationParams->biomeList[indexBiome].asset;
+
+      //Set the Mesh to the Instance
+      InstancedList[indexBiome]->SetStaticMesh(asset.mesh.Get());
+
+      // Asset Collision
+      if (!asset.collision) {
+        InstancedList[indexBiome]->BodyInstance.SetCollisionEnabled(ECollisionEnabled::NoCollision);
+      }
+
+      //Add the assets to the Instanced Object
+      for (const FTransform& transform : assetTransforms[indexBiome]) {
+        InstancedList[indexBiome]->AddInstance(transform);
       }
     }
   }
 }
 
-void ATG_Tile::SetupAssets(FTileSettings tSettings) {
-  if (TerrainGenerator) {
-    UE_LOG(LogTile, Log, TEXT("TILE[%d] Setup Assets"), TileID);
-    if (TerrainGenerator->spawnAssets) {
-      // Set Seed of this tile for the randome trees
-      FMath::RandInit(TileSeed);
-
-      // For each Biome
-      for (int indexBiome = 0; indexBiome < TerrainGenerator->biomeList.Num(); indexBiome++)
-      {
-        // If exist some type of asset
-        if (TerrainGenerator->biomeList[indexBiome].asset.mesh != nullptr) {
-
-          //Set the Mesh to the Instance
-          InstancedList[indexBiome]->SetStaticMesh(TerrainGenerator->biomeList[indexBiome].asset.mesh);
-
-          // Vertices
-          for (auto Elem : ZPositions) {
-            // Get Perlin Value
-            float ZPos = Elem.Value / TerrainGenerator->maxHeight;
-
-            // Clamp
-            if (ZPos < 0.0f) { ZPos = 0.0f; }
-            else if (ZPos >= 1.0f) { ZPos = 1.f; }
-
-            // Set the VertexColor depend the Height
-            if (ZPos >= TerrainGenerator->biomeList[indexBiome].minHeight) {
-              if (ZPos <= TerrainGenerator->biomeList[indexBiome].maxHeight) {
-                // Get the asset Settings
-                FAssetSettings asset = TerrainGenerator->biomeList[indexBiome].asset;
-
-                // Get Perlin Noise from Assets value
-                float randomAsset = FMath::RandRange(0.0f, 1.f);
-
-                // If exist asset here
-                if (randomAsset <= asset.probability) {
-                  FVector thisTrans = this->GetActorLocation();
-                  float posX = TileX * tSettings.getTileSize();
-                  float posY = TileY * tSettings.getTileSize();
-                  FVector2D localPos = Elem.Key * tSettings.getLOD();
-
-                  // Asset Position
-                  FVector assetLocation(localPos.X, localPos.Y, Elem.Value);
-
-                  // Asset Scale
-                  FVector assetScale = FVector(1.f, 1.f, 1.f);
-                  if (asset.randomScale) {
-                    assetScale.X = FMath::FRandRange(1.f, asset.maxRandomScale.X);
-                    assetScale.Y = FMath::FRandRange(1.f, asset.maxRandomScale.Y);
-                    assetScale.Z = FMath::FRandRange(1.f, asset.maxRandomScale.Z);
-                  }
-
-                  // Asset Rotation
-                  FRotator assetRotation = FRotator::ZeroRotator;
-                  if (asset.randomRotation) {
-                    assetRotation.Pitch = FMath::FRandRange(0.f, 360.f);
-                    assetRotation.Roll = FMath::FRandRange(0.f, 360.f);
-                    assetRotation.Yaw = FMath::FRandRange(0.f, 360.f);
-                  }
-
-                  // Asset Collision
-                  if (!asset.collision) {
-                    InstancedList[indexBiome]->BodyInstance.SetCollisionEnabled(ECollisionEnabled::NoCollision);
-                  }
-
-                  //Add the asset to the Instanced Object
-                  InstancedList[indexBiome]->AddInstance(FTransform(assetRotation, assetLocation, assetScale));
-                }
-              } // biome max height
-            } // biome min height
-          } //end for each vertex
-        } //end if existAsset
-      } //end for biome list
-    } //end if spawnAssets
+void ATG_Tile::ReleaseTile() {
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_ReleaseTile);
+  TG_TILE_EVENT(Release, TileID, TileX, TileY, 0);
+  // Hide the Tile
+  UpdateVisibility(false, false);
+
+  // Ignore a generation still running for the old coords
+  BuildSerial++;
+
+  // Free the mesh sections, the next Commit creates them again
+  if (Generated) {
+    RuntimeMesh->ClearAllMeshSections();
+    Generated = false;
+  }
+  LODSectionsBuilt = 0;
+  CurrentLOD = -1;
+  for (FTG_IndexBufferPtr& triangles : LODTriangles) {
+    triangles.Reset();
+  }
+
+  // Free the instances
+  for (int i = 0; i < InstancedList.Num(); ++i) {
+    InstancedList[i]->ClearInstances();
+  }
+
+  // Free the CPU buffers
+  PendingLODs.Empty();
+  HeightField.Empty();
+  GenerationParams.Reset();
+}
+
+SIZE_T ATG_Tile::GetResidentBytes() const {
+  SIZE_T bytes = HeightField.GetAllocatedSize();
+
+  // Levels waiting for their section
+  for (const TSharedPtr<FRuntimeMeshBuilder>& mesh : PendingLODs) {
+    if (mesh.IsValid()) {
+      bytes += mesh->GetPositionStream().GetAllocatedSize()
+        + mesh->GetTangentStream().GetAllocatedSize()
+        + mesh->GetUVStream().GetAllocatedSize()
+        + mesh->GetColorStream().GetAllocatedSize();
+    }
+  }
+
+  // The sections keep the mesh for the collision and a copy for the render thread,
+  // with the streams of their layout (half UVs, colors and index size of the Compact format)
+  for (int lod = 0; lod < FTG_TileLOD::MaxLODs; ++lod) {
+    if (LODSectionsBuilt & (1u << lod)) {
+      bytes += 2 * (LODVertexBytes[lod] + LODTriangles[lod]->Indices.Num() * LODIndexSize[lod]);
+    }
+  }
+
+  // Instances
+  for (const UInstancedStaticMeshComponent* instanced : InstancedList) {
+    bytes += instanced->GetInstanceCount() * (sizeof(FInstancedStaticMeshInstanceData) + sizeof(FMatrix));
   }
+
+  return bytes;
 }
 
 FString ATG_Tile::GetTileNameCoords(int x, int y)
@@ -530,6 +489,8 @@ void ATG_Tile::SetVisibile(bool option)
 
 void ATG_Tile::SetVisibileAsset(bool option)
 {
+  VisibleAsset = option;
+
   // Show or Hide the Assets
   for (int i = 0; i < InstancedList.Num(); ++i) {
     InstancedList[i]->SetVisibility(option, true);
@@ -0,0 +1,408 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#include "TG_TileBuilder.h"
+#include "TG_VertexTemplateCache.h"
+#include "TG_TileCache.h"
+#include "TG_WorldPack.h"
+#include "TG_Stats.h"
+#include "TG_TileEventLog.h"
+
+DECLARE_CYCLE_STAT(TEXT("TG - Build Tile"), STAT_TerrainGenerator_BuildTile, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Build Tile - Init Mesh"), STAT_TerrainGenerator_InitMesh, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Build Tile - Load"), STAT_TerrainGenerator_LoadTile, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Build Tile - Save"), STAT_TerrainGenerator_SaveTile, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Build Tile - Vertices"), STAT_TerrainGenerator_Vertices, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Build Tile - Noise"), STAT_TerrainGenerator_Noise, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Build Tile - Normals"), STAT_TerrainGenerator_Normals, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Build Tile - Biomes"), STAT_TerrainGenerator_Biomes, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Build Tile - Assets"), STAT_TerrainGenerator_Assets, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Build Tile - LODs"), STAT_TerrainGenerator_LODs, STATGROUP_TerrainGenerator);
+
+FTG_TileBuilder::FTG_TileBuilder(const FTG_GenerationParams& InParams, FTG_TileBuildResult& InResult)
+  : Params(InParams)
+  , Result(InResult)
+{
+}
+
+void FTG_TileBuilder::Build(int tileID, int coordX, int coordY)
+{
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_BuildTile);
+  TG_TRACE_SCOPE(TG_BuildTile);
+
+  // Tile Info
+  Result.TileID = tileID;
+  Result.TileX = coordX;
+  Result.TileY = coordY;
+  Result.maxHeight = 0.f;
+  RandomStream.Initialize(Params.Seed * coordX + coordY);
+
+  // Seconds since the previous stage
+  FTG_TileBuildTimings& Timings = Result.Timings;
+  Timings = FTG_TileBuildTimings();
+  double StageStart = FPlatformTime::Seconds();
+  auto Lap = [&StageStart]() {
+    double Now = FPlatformTime::Seconds();
+    double Elapsed = Now - StageStart;
+    StageStart = Now;
+    return Elapsed;
+  };
+
+  // Initialize the values to default
+  InitMeshToCreate();
+  Timings.Init = Lap();
+
+  // Heights, normals, colors and assets of a Tile built before with the same settings
+  bool loaded = false;
+  {
+    SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_LoadTile);
+    if (Params.worldPack.IsValid() && Params.worldPack->Load(Params, coordX, coordY, *Mesh, Result)) {
+      TG_TILE_EVENT(LoadedFromPack, Result.TileID, coordX, coordY, 0);
+      loaded = true;
+    }
+    else if (Params.useTileCache && FTG_TileCache::Load(Params, coordX, coordY, *Mesh, Result)) {
+      TG_TILE_EVENT(LoadedFromCache, Result.TileID, coordX, coordY, 0);
+      loaded = true;
+    }
+  }
+
+  if (loaded) {
+    WriteHeights();
+    Timings.Load = Lap();
+  }
+  else {
+    Timings.Load = Lap();
+
+    // Generate everything (the triangles are shared, see FTG_IndexBufferCache)
+    GenerateVertices();
+    Timings.Vertices = Lap();
+    GenerateNormalTangents();
+    Timings.Normals = Lap();
+
+    // Normalized with the Seed-wide max height, so every Tile is classified on its own
+    SetupBiomes();
+    Timings.Biomes = Lap();
+    SetupAssets();
+    Timings.Assets = Lap();
+
+    if (Params.useTileCache) {
+      SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_SaveTile);
+      FTG_TileCache::Save(Params, *Mesh, Result);
+      Timings.Save = Lap();
+    }
+  }
+
+  // Decimate the finished mesh
+  GenerateLODs();
+  Timings.LODs = Lap();
+}
+
+void FTG_TileBuilder::InitMeshToCreate()
+{
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_InitMesh);
+  TG_TILE_STAGE_EVENT(InitMesh, Result.TileID, Result.TileX, Result.TileY, 0);
+  int numVertices = Params.tileSettings.ArraySize;
+
+  // Compact: half UVs, 16-bit indices when every vertex fits and no colors if nothing writes them
+  bool compact = Params.vertexFormat == TileVertexFormat::TileVertexFormat_Compact;
+  bool halfUVs = compact;
+  bool indices32 = !compact || numVertices > 65536;
+  UsesColors = !compact || Params.useVertexColor || Params.useHeightMap;
+
+  // The vertices are written straight into the streams of the section, which take them by move
+  Result.LODMeshes.Reset();
+  Result.LODMeshes.Add(MakeRuntimeMeshBuilder(false, !halfUVs, 1, indices32));
+  Mesh = Result.LODMeshes[0].Get();
+  Mesh->SetNumVertices(numVertices);
+
+  // XY and UV only depend on the grid, GenerateVertices only writes the heights
+  const FTG_VertexTemplatePtr& vertexTemplate = Params.vertexTemplate;
+  Mesh->SetPositions(0, vertexTemplate->Positions, numVertices, false);
+  if (halfUVs) {
+    Mesh->SetUVs(0, vertexTemplate->UVHalf, numVertices, false);
+  }
+  else {
+    Mesh->SetUVs(0, vertexTemplate->UV, numVertices, false);
+  }
+
+  // Default color (GenerateNormalTangents writes every normal and tangent)
+  if (UsesColors) {
+    FMemory::Memset(Mesh->GetColorStream().GetData(), 0xFF, Mesh->GetColorStream().Num());
+  }
+  else {
+    Mesh->GetColorStream().Empty();
+  }
+}
+
+void FTG_TileBuilder::GenerateVertices()
+{
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_Vertices);
+  TG_TILE_STAGE_EVENT(Vertices, Result.TileID, Result.TileX, Result.TileY, 0);
+
+  int NumberOfQuadsPerLine = Params.tileSettings.getArrayLineSize();
+  float LOD = Params.tileSettings.getLOD();
+  double worldX = (double)Result.TileX * Params.tileSettings.getTileSize();
+  double worldY = (double)Result.TileY * Params.tileSettings.getTileSize();
+
+  // Evaluate the noise of the whole grid in one batch
+  Result.HeightField.SetNumUninitialized(Params.tileSettings.ArraySize, false);
+  if (Params.HasAnalyticNormals()) {
+    // The derivatives come with the heights, so the normals need no apron and are seamless by construction
+    ApronHeightField.Reset();
+    SlopeX.SetNumUninitialized(Params.tileSettings.ArraySize, false);
+    SlopeY.SetNumUninitialized(Params.tileSettings.ArraySize, false);
+    {
+      SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_Noise);
+      Params.GetAlgorithmGrid(worldX, worldY, LOD, NumberOfQuadsPerLine, Result.HeightField.GetData(), SlopeX.GetData(), SlopeY.GetData());
+    }
+
+    for (int i = 0; i < Result.HeightField.Num(); ++i) {
+      Result.HeightField[i] = ScaleZWithHeightRange(Result.HeightField[i]);
+      SlopeX[i] = ScaleZWithHeightRange(SlopeX[i]);
+      SlopeY[i] = ScaleZWithHeightRange(SlopeY[i]);
+    }
+  }
+  else if (Params.seamlessNormals) {
+    SlopeX.Reset();
+    SlopeY.Reset();
+    // Grid with one extra vertex on each side, the inner part is the HeightField
+    int ApronLineSize = NumberOfQuadsPerLine + 2;
+    ApronHeightField.SetNumUninitialized(ApronLineSize * ApronLineSize, false);
+    {
+      SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_Noise);
+      Params.GetAlgorithmGrid(worldX - LOD, worldY - LOD, LOD, ApronLineSize, ApronHeightField.GetData());
+    }
+
+    for (int i = 0; i < ApronHeightField.Num(); ++i) {
+      ApronHeightField[i] = ScaleZWithHeightRange(ApronHeightField[i]);
+    }
+    for (int y = 0; y < NumberOfQuadsPerLine; y++) {
+      FMemory::Memcpy(&Result.HeightField[GetValueIndexForCoordinates(0, y)], &ApronHeightField[(y + 1) * ApronLineSize + 1], NumberOfQuadsPerLine * sizeof(float));
+    }
+  }
+  else {
+    SlopeX.Reset();
+    SlopeY.Reset();
+    ApronHeightField.Reset();
+    {
+      SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_Noise);
+      Params.GetAlgorithmGrid(worldX, worldY, LOD, NumberOfQuadsPerLine, Result.HeightField.GetData());
+    }
+
+    for (int i = 0; i < Result.HeightField.Num(); ++i) {
+      Result.HeightField[i] = ScaleZWithHeightRange(Result.HeightField[i]);
+    }
+  }
+
+  WriteHeights();
+}
+
+void FTG_TileBuilder::WriteHeights()
+{
+  // Set the Algorithm Value, XY come from the vertex template
+  const float* Heights = Result.HeightField.GetData();
+  FVector* Vertices = reinterpret_cast<FVector*>(Mesh->GetPositionStream().GetData());
+  float MaxZ = Result.maxHeight;
+  for (int index = 0; index < Result.HeightField.Num(); ++index) {
+    Vertices[index].Z = Heights[index];
+
+    // Save the Maximum Z Position
+    MaxZ = FMath::Max(MaxZ, Heights[index]);
+  }
+  Result.maxHeight = MaxZ;
+}
+
+void FTG_TileBuilder::GenerateNormalTangents() {
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_Normals);
+  int LineSize = Params.tileSettings.getArrayLineSize();
+  float LOD = Params.tileSettings.getLOD();
+
+  // Exact slopes of the noise
+  if (SlopeX.Num() == Result.HeightField.Num()) {
+    for (int index = 0; index < SlopeX.Num(); ++index) {
+      float dX = SlopeX[index];
+      float dY = SlopeY[index];
+      Mesh->SetNormalTangent(index, FVector(-dX, -dY, 1.f).GetUnsafeNormal(), FRuntimeMeshTangent(FVector(1.f, 0.f, dX).GetUnsafeNormal(), false));
+    }
+    return;
+  }
+
+  // With the apron every vertex has 4 neighbours, so the tile border uses the same
+  // central difference as the interior and matches the tile next to it
+  if (ApronHeightField.Num() == (LineSize + 2) * (LineSize + 2)) {
+    int ApronLineSize = LineSize + 2;
+    float InvSpan = 1.f / (2.f * LOD);
+
+    for (int y = 0; y < LineSize; y++) {
+      const float* Row = &ApronHeightField[(y + 1) * ApronLineSize + 1];
+      for (int x = 0; x < LineSize; x++) {
+        float dX = (Row[x + 1] - Row[x - 1]) * InvSpan;
+        float dY = (Row[x + ApronLineSize] - Row[x - ApronLineSize]) * InvSpan;
+
+        int index = GetValueIndexForCoordinates(x, y);
+        Mesh->SetNormalTangent(index, FVector(-dX, -dY, 1.f).GetUnsafeNormal(), FRuntimeMeshTangent(FVector(1.f, 0.f, dX).GetUnsafeNormal(), false));
+      }
+    }
+    return;
+  }
+
+  // Without apron the border falls back to a one-sided difference
+  for (int y = 0; y < LineSize; y++) {
+    int y0 = FMath::Max(y - 1, 0);
+    int y1 = FMath::Min(y + 1, LineSize - 1);
+    for (int x = 0; x < LineSize; x++) {
+      int x0 = FMath::Max(x - 1, 0);
+      int x1 = FMath::Min(x + 1, LineSize - 1);
+      float dX = (Result.HeightField[GetValueIndexForCoordinates(x1, y)] - Result.HeightField[GetValueIndexForCoordinates(x0, y)]) / ((x1 - x0) * LOD);
+      float dY = (Result.HeightField[GetValueIndexForCoordinates(x, y1)] - Result.HeightField[GetValueIndexForCoordinates(x, y0)]) / ((y1 - y0) * LOD);
+
+      int index = GetValueIndexForCoordinates(x, y);
+      Mesh->SetNormalTangent(index, FVector(-dX, -dY, 1.f).GetUnsafeNormal(), FRuntimeMeshTangent(FVector(1.f, 0.f, dX).GetUnsafeNormal(), false));
+    }
+  }
+}
+
+void FTG_TileBuilder::SetupBiomes()
+{
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_Biomes);
+  TG_TILE_STAGE_EVENT(Biomes, Result.TileID, Result.TileX, Result.TileY, 0);
+  if (!UsesColors) {
+    return;
+  }
+
+  if (Params.useVertexColor == true) {
+    // Vertices
+    for (int i = 0; i < Result.HeightField.Num(); ++i) {
+      float ZPos = GetNormalizedHeight(i);
+
+      // For each Biome
+      for (int indexBiome = 0; indexBiome < Params.biomeList.Num(); indexBiome++)
+      {
+        const FTG_BiomeParams& biome = Params.biomeList[indexBiome];
+
+        // Set the VertexColor depend the Height
+        if (ZPos >= biome.minHeight && ZPos <= biome.maxHeight && biome.vertexColors.Num() > 0) {
+          // Select a random Color
+          int randomVertexColor = RandomStream.RandRange(0, biome.vertexColors.Num() - 1);
+
+          // Set the Vertex Color
+          Mesh->SetColor(i, biome.vertexColors[randomVertexColor]);
+        }
+      }
+    }
+  }
+
+  if (Params.useHeightMap == true) {
+    // Calculate the Height Map
+    for (int i = 0; i < Result.HeightField.Num(); ++i) {
+      float clamped = GetNormalizedHeight(i) * 255;
+
+      // Set the Vertex Color
+      Mesh->SetColor(i, FColor(clamped, clamped, clamped));
+    }
+  }
+}
+
+void FTG_TileBuilder::SetupAssets()
+{
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_Assets);
+  Result.AssetTransforms.Reset();
+  if (!Params.spawnAssets) {
+    return;
+  }
+  TG_TILE_STAGE_EVENT(Assets, Result.TileID, Result.TileX, Result.TileY, 0);
+
+  int LineSize = Params.tileSettings.getArrayLineSize();
+  float LOD = Params.tileSettings.getLOD();
+
+  // For each Biome
+  Result.AssetTransforms.SetNum(Params.biomeList.Num());
+  for (int indexBiome = 0; indexBiome < Params.biomeList.Num(); indexBiome++)
+  {
+    const FTG_BiomeParams& biome = Params.biomeList[indexBiome];
+
+    // If exist some type of asset
+    if (!biome.asset.hasMesh) {
+      continue;
+    }
+    const FTG_AssetParams& asset = biome.asset;
+
+    // Vertices
+    for (int i = 0; i < Result.HeightField.Num(); ++i) {
+      float ZPos = GetNormalizedHeight(i);
+      if (ZPos < biome.minHeight || ZPos > biome.maxHeight) {
+        continue;
+      }
+
+      // If exist asset here
+      if (RandomStream.FRandRange(0.f, 1.f) > asset.probability) {
+        continue;
+      }
+
+      // Asset Position
+      FVector assetLocation((i % LineSize) * LOD, (i / LineSize) * LOD, Result.HeightField[i]);
+
+      // Asset Scale
+      FVector assetScale = FVector(1.f, 1.f, 1.f);
+      if (asset.randomScale) {
+        assetScale.X = RandomStream.FRandRange(1.f, asset.maxRandomScale.X);
+        assetScale.Y = RandomStream.FRandRange(1.f, asset.maxRandomScale.Y);
+        assetScale.Z = RandomStream.FRandRange(1.f, asset.maxRandomScale.Z);
+      }
+
+      // Asset Rotation
+      FRotator assetRotation = FRotator::ZeroRotator;
+      if (asset.randomRotation) {
+        assetRotation.Pitch = RandomStream.FRandRange(0.f, 360.f);
+        assetRotation.Roll = RandomStream.FRandRange(0.f, 360.f);
+        assetRotation.Yaw = RandomStream.FRandRange(0.f, 360.f);
+      }
+
+      Result.AssetTransforms[indexBiome].Add(FTransform(assetRotation, assetLocation, assetScale));
+    }
+  }
+}
+
+void FTG_TileBuilder::GenerateLODs()
+{
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_LODs);
+  TG_TILE_STAGE_EVENT(LODs, Result.TileID, Result.TileX, Result.TileY, 0);
+  int numLODs = FMath::Clamp(Params.tileSettings.NumLODs, 1, FTG_TileLOD::MaxLODs);
+
+  for (int lod = 1; lod < numLODs; ++lod) {
+    TSharedPtr<FRuntimeMeshBuilder> decimated = MakeRuntimeMeshBuilder(*Mesh);
+    FTG_TileLOD::BuildVertices(*Mesh, Params.tileSettings.getArrayLineSize(), lod, *decimated);
+    Result.LODMeshes.Add(decimated);
+  }
+}
+
+int FTG_TileBuilder::GetValueIndexForCoordinates(int x, int y) const
+{
+  return x + (y * Params.tileSettings.getArrayLineSize());
+}
+
+FVector2D FTG_TileBuilder::GetVerticePosition(float x, float y) const
+{
+  return FVector2D(
+    x * Params.tileSettings.getLOD(),
+    y * Params.tileSettings.getLOD()
+  );
+}
+
+FVector2D FTG_TileBuilder::CalculateUV(float x, float y) const
+{
+  return FVector2D(
+    x / Params.tileSettings.TextureScale,
+    y / Params.tileSettings.TextureScale
+  );
+}
+
+float FTG_TileBuilder::ScaleZWithHeightRange(double value) const {
+  return value * Params.tileSettings.getHeightRange();
+}
+
+float FTG_TileBuilder::GetNormalizedHeight(int index) const {
+  float ZPos = Params.maxHeight > 0.f ? Result.HeightField[index] / Params.maxHeight : 0.f;
+
+  // Clamp
+  return FMath::Clamp(ZPos, 0.f, 1.f);
+}
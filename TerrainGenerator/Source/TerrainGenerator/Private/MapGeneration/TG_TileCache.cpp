@@ -0,0 +1,195 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#include "TG_TileCache.h"
+#include "TG_TileBuilder.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/FileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTileCache, Log, All);
+
+// Floats of every asset instance
+static const int FloatsPerInstance = 10;
+
+FString FTG_TileCache::GetCacheDir(const FTG_GenerationParams& params)
+{
+  return FPaths::ProjectSavedDir() / TEXT("TerrainCache") / FString::Printf(TEXT("%d_%016llx"), params.Seed, params.SettingsHash);
+}
+
+FString FTG_TileCache::GetTilePath(const FTG_GenerationParams& params, int x, int y)
+{
+  return GetCacheDir(params) / FString::Printf(TEXT("%d_%d.tile"), x, y);
+}
+
+bool FTG_TileCache::Load(const FTG_GenerationParams& params, int x, int y, FRuntimeMeshBuilder& mesh, FTG_TileBuildResult& result)
+{
+  FString path = GetTilePath(params, x, y);
+
+  // Map the file when the platform can, the chunk is read in place
+  IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+  TUniquePtr<IMappedFileHandle> mappedFile(platformFile.OpenMapped(*path));
+  if (mappedFile.IsValid()) {
+    TUniquePtr<IMappedFileRegion> region(mappedFile->MapRegion());
+    if (region.IsValid()) {
+      return ReadChunk(params, x, y, region->GetMappedPtr(), region->GetMappedSize(), mesh, result);
+    }
+  }
+
+  // Fallback: read the whole file
+  TArray<uint8> bytes;
+  if (!platformFile.FileExists(*path) || !FFileHelper::LoadFileToArray(bytes, *path, FILEREAD_Silent)) {
+    return false;
+  }
+  return ReadChunk(params, x, y, bytes.GetData(), bytes.Num(), mesh, result);
+}
+
+bool FTG_TileCache::Save(const FTG_GenerationParams& params, FRuntimeMeshBuilder& mesh, const FTG_TileBuildResult& result)
+{
+  TArray<uint8> bytes;
+  WriteChunk(params, mesh, result, bytes);
+
+  // Write to a temporary file and move it, so a reader never sees half a Tile
+  FString path = GetTilePath(params, result.TileX, result.TileY);
+  FString tempPath = FString::Printf(TEXT("%s.%u.tmp"), *path, FPlatformTLS::GetCurrentThreadId());
+  if (!FFileHelper::SaveArrayToFile(bytes, *tempPath)) {
+    UE_LOG(LogTileCache, Warning, TEXT("TILE[%d] Could not write %s"), result.TileID, *tempPath);
+    return false;
+  }
+  if (!IFileManager::Get().Move(*path, *tempPath, true, true)) {
+    IFileManager::Get().Delete(*tempPath, false, false, true);
+    return false;
+  }
+  return true;
+}
+
+void FTG_TileCache::WriteChunk(const FTG_GenerationParams& params, FRuntimeMeshBuilder& mesh, const FTG_TileBuildResult& result, TArray<uint8>& out)
+{
+  FTG_TileChunkHeader header;
+  FMemory::Memzero(header);
+  header.Magic = FTG_TileChunkHeader::ChunkMagic;
+  header.Version = FTG_TileChunkHeader::ChunkVersion;
+  header.SettingsHash = params.SettingsHash;
+  header.Seed = params.Seed;
+  header.TileX = result.TileX;
+  header.TileY = result.TileY;
+  header.NumVertices = result.HeightField.Num();
+  header.TangentBytes = mesh.GetTangentStream().Num();
+  header.ColorBytes = mesh.GetColorStream().Num();
+  header.NumBiomes = result.AssetTransforms.Num();
+
+  int64 numInstances = 0;
+  for (const TArray<FTransform>& transforms : result.AssetTransforms) {
+    numInstances += transforms.Num();
+  }
+
+  int64 size = sizeof(FTG_TileChunkHeader)
+    + header.NumVertices * sizeof(float)
+    + header.TangentBytes
+    + header.ColorBytes
+    + header.NumBiomes * sizeof(uint32)
+    + numInstances * FloatsPerInstance * sizeof(float);
+  out.SetNumUninitialized(size);
+
+  uint8* cursor = out.GetData();
+  auto Write = [&cursor](const void* data, int64 bytes) {
+    FMemory::Memcpy(cursor, data, bytes);
+    cursor += bytes;
+  };
+
+  Write(&header, sizeof(header));
+  Write(result.HeightField.GetData(), header.NumVertices * sizeof(float));
+  Write(mesh.GetTangentStream().GetData(), header.TangentBytes);
+  Write(mesh.GetColorStream().GetData(), header.ColorBytes);
+  for (const TArray<FTransform>& transforms : result.AssetTransforms) {
+    uint32 count = transforms.Num();
+    Write(&count, sizeof(count));
+  }
+  for (const TArray<FTransform>& transforms : result.AssetTransforms) {
+    for (const FTransform& transform : transforms) {
+      FQuat rotation = transform.GetRotation();
+      FVector location = transform.GetTranslation();
+      FVector scale = transform.GetScale3D();
+      float instance[FloatsPerInstance] = {
+        rotation.X, rotation.Y, rotation.Z, rotation.W,
+        location.X, location.Y, location.Z,
+        scale.X, scale.Y, scale.Z
+      };
+      Write(instance, sizeof(instance));
+    }
+  }
+  check(cursor == out.GetData() + out.Num());
+}
+
+bool FTG_TileCache::ReadChunk(const FTG_GenerationParams& params, int x, int y, const uint8* data, int64 size, FRuntimeMeshBuilder& mesh, FTG_TileBuildResult& result)
+{
+  if (data == nullptr || size < (int64)sizeof(FTG_TileChunkHeader)) {
+    return false;
+  }
+
+  FTG_TileChunkHeader header;
+  FMemory::Memcpy(&header, data, sizeof(header));
+
+  // Same format, same settings, same Tile and the same streams the mesh has now
+  if (header.Magic != FTG_TileChunkHeader::ChunkMagic || header.Version != FTG_TileChunkHeader::ChunkVersion ||
+      header.SettingsHash != params.SettingsHash || header.Seed != params.Seed || header.TileX != x || header.TileY != y ||
+      header.NumVertices != (uint32)mesh.NumVertices() ||
+      header.TangentBytes != (uint32)mesh.GetTangentStream().Num() ||
+      header.ColorBytes != (uint32)mesh.GetColorStream().Num()) {
+    return false;
+  }
+
+  int64 fixedSize = sizeof(FTG_TileChunkHeader)
+    + (int64)header.NumVertices * sizeof(float)
+    + header.TangentBytes
+    + header.ColorBytes
+    + (int64)header.NumBiomes * sizeof(uint32);
+  if (size < fixedSize) {
+    return false;
+  }
+
+  const uint8* cursor = data + sizeof(FTG_TileChunkHeader);
+  const uint32* counts = reinterpret_cast<const uint32*>(data + fixedSize - header.NumBiomes * sizeof(uint32));
+  int64 numInstances = 0;
+  for (uint32 i = 0; i < header.NumBiomes; ++i) {
+    uint32 count;
+    FMemory::Memcpy(&count, &counts[i], sizeof(count));
+    numInstances += count;
+  }
+  if (size != fixedSize + numInstances * FloatsPerInstance * (int64)sizeof(float)) {
+    return false;
+  }
+
+  // The chunk is valid, copy it out
+  result.HeightField.SetNumUninitialized(header.NumVertices, false);
+  FMemory::Memcpy(result.HeightField.GetData(), cursor, header.NumVertices * sizeof(float));
+  cursor += header.NumVertices * sizeof(float);
+
+  FMemory::Memcpy(mesh.GetTangentStream().GetData(), cursor, header.TangentBytes);
+  cursor += header.TangentBytes;
+  FMemory::Memcpy(mesh.GetColorStream().GetData(), cursor, header.ColorBytes);
+  cursor += header.ColorBytes;
+  cursor += header.NumBiomes * sizeof(uint32);
+
+  result.AssetTransforms.Reset();
+  result.AssetTransforms.SetNum(header.NumBiomes);
+  for (uint32 indexBiome = 0; indexBiome < header.NumBiomes; ++indexBiome) {
+    uint32 count;
+    FMemory::Memcpy(&count, &counts[indexBiome], sizeof(count));
+
+    TArray<FTransform>& transforms = result.AssetTransforms[indexBiome];
+    transforms.Reserve(count);
+    for (uint32 i = 0; i < count; ++i) {
+      float instance[FloatsPerInstance];
+      FMemory::Memcpy(instance, cursor, sizeof(instance));
+      cursor += sizeof(instance);
+
+      transforms.Add(FTransform(
+        FQuat(instance[0], instance[1], instance[2], instance[3]),
+        FVector(instance[4], instance[5], instance[6]),
+        FVector(instance[7], instance[8], instance[9])));
+    }
+  }
+  return true;
+}
@@ -0,0 +1,140 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#include "TG_TileEventLog.h"
+
+#if TG_TILE_EVENT_LOG
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTileEvents, Log, All);
+
+static int32 GTileEventsSampleEvery = 1;
+static FAutoConsoleVariableRef CVarTileEventsSampleEvery(
+  TEXT("tg.TileEvents.SampleEvery"),
+  GTileEventsSampleEvery,
+  TEXT("Only record the events of 1 in N Tiles (picked by coords, so a Tile keeps its whole history)"));
+
+static FAutoConsoleCommand CmdTileEventsDump(
+  TEXT("tg.TileEvents.Dump"),
+  TEXT("Print the Tile event log, or write it as binary records to the file given as argument"),
+  FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& args) {
+    if (args.Num() > 0) {
+      FTG_TileEventLog::Get().DumpToFile(args[0]);
+    }
+    else {
+      FTG_TileEventLog::Get().DumpToLog();
+    }
+  }));
+
+// Binary dump: header followed by the records, oldest first
+struct FTG_TileEventFileHeader {
+  static const uint32 FileMagic = 0x56455454; // "TTEV"
+  static const uint32 FileVersion = 1;
+
+  uint32 Magic;
+  uint32 Version;
+  uint32 RecordSize;
+  uint32 NumRecords;
+  double SecondsPerCycle;
+};
+
+FTG_TileEventLog& FTG_TileEventLog::Get()
+{
+  static FTG_TileEventLog Log;
+  return Log;
+}
+
+void FTG_TileEventLog::Record(ETG_TileEvent event, int32 tileID, int32 tileX, int32 tileY, uint32 arg)
+{
+  if (GTileEventsSampleEvery > 1) {
+    uint32 hash = HashCombine(GetTypeHash(tileX), GetTypeHash(tileY));
+    if (hash % (uint32)GTileEventsSampleEvery != 0) {
+      return;
+    }
+  }
+
+  uint64 index = (uint64)(FPlatformAtomics::InterlockedIncrement(&Next) - 1) & (Capacity - 1);
+  FTG_TileEventRecord& record = Records[index];
+  record.Cycles = FPlatformTime::Cycles64();
+  record.TileID = tileID;
+  record.TileX = tileX;
+  record.TileY = tileY;
+  record.Arg = arg;
+  record.ThreadId = FPlatformTLS::GetCurrentThreadId();
+  record.Event = (uint8)event;
+}
+
+void FTG_TileEventLog::Snapshot(TArray<FTG_TileEventRecord>& out) const
+{
+  uint64 count = (uint64)FPlatformAtomics::InterlockedCompareExchange(const_cast<volatile int64*>(&Next), 0, 0);
+  uint64 num = FMath::Min(count, (uint64)Capacity);
+
+  out.Reset((int32)num);
+  for (uint64 i = count - num; i != count; ++i) {
+    out.Add(Records[i & (Capacity - 1)]);
+  }
+}
+
+void FTG_TileEventLog::DumpToLog() const
+{
+  TArray<FTG_TileEventRecord> records;
+  Snapshot(records);
+  if (records.Num() == 0) {
+    UE_LOG(LogTileEvents, Display, TEXT("No Tile events"));
+    return;
+  }
+
+  double msPerCycle = FPlatformTime::GetSecondsPerCycle64() * 1000.0;
+  uint64 firstCycle = records[0].Cycles;
+  for (const FTG_TileEventRecord& record : records) {
+    UE_LOG(LogTileEvents, Display, TEXT("%10.3f ms  thread %6u  TILE[%d] [%d, %d]  %-16s %u"),
+      (record.Cycles - firstCycle) * msPerCycle, record.ThreadId, record.TileID, record.TileX, record.TileY,
+      GetEventName((ETG_TileEvent)record.Event), record.Arg);
+  }
+}
+
+bool FTG_TileEventLog::DumpToFile(const FString& path) const
+{
+  TArray<FTG_TileEventRecord> records;
+  Snapshot(records);
+
+  FTG_TileEventFileHeader header;
+  FMemory::Memzero(header);
+  header.Magic = FTG_TileEventFileHeader::FileMagic;
+  header.Version = FTG_TileEventFileHeader::FileVersion;
+  header.RecordSize = sizeof(FTG_TileEventRecord);
+  header.NumRecords = records.Num();
+  header.SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+
+  TArray<uint8> bytes;
+  bytes.Append((const uint8*)&header, sizeof(header));
+  bytes.Append((const uint8*)records.GetData(), records.Num() * sizeof(FTG_TileEventRecord));
+
+  bool success = FFileHelper::SaveArrayToFile(bytes, *path);
+  UE_LOG(LogTileEvents, Display, TEXT("%d Tile events written to %s"), records.Num(), *path);
+  return success;
+}
+
+const TCHAR* FTG_TileEventLog::GetEventName(ETG_TileEvent event)
+{
+  switch (event) {
+    case ETG_TileEvent::Create:          return TEXT("Create");
+    case ETG_TileEvent::LoadedFromPack:  return TEXT("LoadedFromPack");
+    case ETG_TileEvent::LoadedFromCache: return TEXT("LoadedFromCache");
+    case ETG_TileEvent::Commit:          return TEXT("Commit");
+    case ETG_TileEvent::Evict:           return TEXT("Evict");
+    case ETG_TileEvent::Release:         return TEXT("Release");
+    case ETG_TileEvent::InitMesh:        return TEXT("InitMesh");
+    case ETG_TileEvent::Vertices:        return TEXT("Vertices");
+    case ETG_TileEvent::Biomes:          return TEXT("Biomes");
+    case ETG_TileEvent::Assets:          return TEXT("Assets");
+    case ETG_TileEvent::LODs:            return TEXT("LODs");
+    case ETG_TileEvent::CommitMesh:      return TEXT("CommitMesh");
+    case ETG_TileEvent::CommitWater:     return TEXT("CommitWater");
+    case ETG_TileEvent::CommitAssets:    return TEXT("CommitAssets");
+    default:                             return TEXT("Unknown");
+  }
+}
+
+#endif
@@ -0,0 +1,118 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#include "TG_TileLOD.h"
+#include "TG_Stats.h"
+
+DECLARE_CYCLE_STAT(TEXT("TG - Triangles"), STAT_TerrainGenerator_Triangles, STATGROUP_TerrainGenerator);
+DECLARE_CYCLE_STAT(TEXT("TG - Build Tile - LOD Vertices"), STAT_TerrainGenerator_LODVertices, STATGROUP_TerrainGenerator);
+
+int FTG_TileLOD::GetLODLineSize(int lineSize, int lod)
+{
+  int stride = 1 << lod;
+  int quads = lineSize - 1;
+
+  // At least one quad per line
+  return FMath::Max((quads + stride - 1) / stride, 1) + 1;
+}
+
+int FTG_TileLOD::GetSourceIndex(int lineSize, int lod, int i)
+{
+  // The last vertex is always the border of the Tile
+  return FMath::Min(i << lod, lineSize - 1);
+}
+
+/* Copy one element of a packed vertex stream */
+static FORCEINLINE void CopyStreamElement(const TArray<uint8>& from, TArray<uint8>& to, int stride, int fromIndex, int toIndex)
+{
+  if (stride > 0) {
+    FMemory::Memcpy(&to[toIndex * stride], &from[fromIndex * stride], stride);
+  }
+}
+
+void FTG_TileLOD::BuildVertices(FRuntimeMeshBuilder& source, int lineSize, int lod, FRuntimeMeshBuilder& out)
+{
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_LODVertices);
+  int lodLineSize = GetLODLineSize(lineSize, lod);
+  out.SetNumVertices(lodLineSize * lodLineSize);
+
+  // Same layout in both meshes, so every stream is copied element by element
+  int numSource = FMath::Max(source.NumVertices(), 1);
+  int positionStride = source.GetPositionStream().Num() / numSource;
+  int tangentStride = source.GetTangentStream().Num() / numSource;
+  int uvStride = source.GetUVStream().Num() / numSource;
+  int colorStride = source.GetColorStream().Num() / numSource;
+
+  for (int y = 0; y < lodLineSize; y++) {
+    int sourceRow = GetSourceIndex(lineSize, lod, y) * lineSize;
+    for (int x = 0; x < lodLineSize; x++) {
+      int from = sourceRow + GetSourceIndex(lineSize, lod, x);
+      int to = x + y * lodLineSize;
+
+      CopyStreamElement(source.GetPositionStream(), out.GetPositionStream(), positionStride, from, to);
+      CopyStreamElement(source.GetTangentStream(), out.GetTangentStream(), tangentStride, from, to);
+      CopyStreamElement(source.GetUVStream(), out.GetUVStream(), uvStride, from, to);
+      CopyStreamElement(source.GetColorStream(), out.GetColorStream(), colorStride, from, to);
+    }
+  }
+
+  // Streams omitted by the source (e.g. no vertex colors)
+  if (source.GetColorStream().Num() == 0) {
+    out.GetColorStream().Empty();
+  }
+}
+
+/* Move the vertex i of a stitched edge to the previous vertex of the coarse neighbour */
+static FORCEINLINE int SnapToCoarse(int i, int last, uint8 levels)
+{
+  if (levels == 0 || i == last) {
+    return i;
+  }
+  return (i >> levels) << levels;
+}
+
+void FTG_TileLOD::BuildTriangles(int lodLineSize, const FTG_LODStitch& stitch, TArray<int32>& out)
+{
+  SCOPE_CYCLE_COUNTER(STAT_TerrainGenerator_Triangles);
+  int last = lodLineSize - 1;
+  int quadsPerLine = lodLineSize - 1;
+
+  out.Reset(quadsPerLine * quadsPerLine * 6);
+
+  // Index of the vertex after collapsing the stitched edges
+  auto Vertex = [&](int x, int y) {
+    if (y == 0) {
+      x = SnapToCoarse(x, last, stitch.Edge[0]);
+    }
+    else if (y == last) {
+      x = SnapToCoarse(x, last, stitch.Edge[2]);
+    }
+    if (x == last) {
+      y = SnapToCoarse(y, last, stitch.Edge[1]);
+    }
+    else if (x == 0) {
+      y = SnapToCoarse(y, last, stitch.Edge[3]);
+    }
+    return x + y * lodLineSize;
+  };
+
+  // Collapsed triangles are skipped
+  auto AddTriangle = [&out](int32 a, int32 b, int32 c) {
+    if (a != b && b != c && a != c) {
+      out.Add(a);
+      out.Add(b);
+      out.Add(c);
+    }
+  };
+
+  for (int y = 0; y < quadsPerLine; y++) {
+    for (int x = 0; x < quadsPerLine; x++) {
+      int botLeft = Vertex(x, y);
+      int topLeft = Vertex(x, y + 1);
+      int topRight = Vertex(x + 1, y + 1);
+      int botRight = Vertex(x + 1, y);
+
+      AddTriangle(botLeft, topLeft, topRight);
+      AddTriangle(botLeft, topRight, botRight);
+    }
+  }
+}
@@ -0,0 +1,196 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#include "TG_TileScheduler.h"
+#include "Misc/QueuedThreadPool.h"
+#include "Misc/IQueuedWork.h"
+#include "Misc/ScopeLock.h"
+
+/* Work item of the pool, releases its worker slot when it ends */
+class FTG_TileWork : public IQueuedWork
+{
+public:
+  FTG_TileWork(TFunction<void()> InWork, FThreadSafeCounter& InCounter)
+    : Work(MoveTemp(InWork))
+    , Counter(InCounter)
+  {
+  }
+
+  virtual void DoThreadedWork() override
+  {
+    Work();
+    Counter.Decrement();
+    delete this;
+  }
+
+  virtual void Abandon() override
+  {
+    Counter.Decrement();
+    delete this;
+  }
+
+private:
+  TFunction<void()> Work;
+  FThreadSafeCounter& Counter;
+};
+
+FTG_TileScheduler::FTG_TileScheduler()
+{
+}
+
+FTG_TileScheduler::~FTG_TileScheduler()
+{
+  Stop();
+}
+
+void FTG_TileScheduler::Start(int numWorkers)
+{
+  if (Pool) {
+    return;
+  }
+
+  // Leave one core for the game thread
+  if (numWorkers <= 0) {
+    numWorkers = FPlatformMisc::NumberOfCoresIncludingHyperthreads() - 1;
+  }
+  Workers = FMath::Max(numWorkers, 1);
+
+  Pool = FQueuedThreadPool::Allocate();
+  Pool->Create(Workers, 128 * 1024, TPri_BelowNormal);
+}
+
+void FTG_TileScheduler::Stop()
+{
+  Queue.Empty();
+  QueuedCoords.Empty();
+
+  if (Pool) {
+    // Abandons the work not started and waits for the running one
+    Pool->Destroy();
+    delete Pool;
+    Pool = nullptr;
+  }
+  Workers = 0;
+
+  // No worker is running, the finished Tiles are dropped
+  {
+    FScopeLock lock(&CompletedLock);
+    Completed.Empty();
+    NumCompleted.Reset();
+  }
+  Pending.Empty();
+}
+
+void FTG_TileScheduler::Enqueue(FVector2D coord, ATG_Tile* tile)
+{
+  if (QueuedCoords.Contains(coord)) {
+    return;
+  }
+
+  FTG_TileJob job;
+  job.coord = coord;
+  job.tile = tile;
+  Queue.Add(job);
+  QueuedCoords.Add(coord);
+}
+
+void FTG_TileScheduler::Cancel(FVector2D coord)
+{
+  if (QueuedCoords.Remove(coord) == 0) {
+    return;
+  }
+
+  for (int i = Queue.Num() - 1; i >= 0; --i) {
+    if (Queue[i].coord == coord) {
+      Queue.RemoveAtSwap(i, 1, false);
+      break;
+    }
+  }
+}
+
+void FTG_TileScheduler::Update(FVector2D center, int cancelRange, int maxAdmissions, TArray<FTG_TileJob>& admitted)
+{
+  if (Queue.Num() == 0) {
+    return;
+  }
+
+  // Cancel the jobs that are not in range anymore
+  if (cancelRange >= 0) {
+    for (int i = Queue.Num() - 1; i >= 0; --i) {
+      FVector2D offset = Queue[i].coord - center;
+      if (FMath::Abs(offset.X) > cancelRange || FMath::Abs(offset.Y) > cancelRange) {
+        QueuedCoords.Remove(Queue[i].coord);
+        Queue.RemoveAtSwap(i, 1, false);
+      }
+    }
+  }
+
+  int freeWorkers = Workers - InFlight.GetValue();
+  int count = FMath::Min3(freeWorkers, maxAdmissions, Queue.Num());
+  if (count <= 0) {
+    return;
+  }
+
+  // Nearest Tiles first
+  Queue.Sort([center](const FTG_TileJob& A, const FTG_TileJob& B) {
+    return FVector2D::DistSquared(A.coord, center) < FVector2D::DistSquared(B.coord, center);
+  });
+
+  for (int i = 0; i < count; ++i) {
+    QueuedCoords.Remove(Queue[i].coord);
+    admitted.Add(Queue[i]);
+  }
+  Queue.RemoveAt(0, count, false);
+}
+
+void FTG_TileScheduler::Launch(TFunction<void()> work)
+{
+  check(Pool);
+  InFlight.Increment();
+  Pool->AddQueuedWork(new FTG_TileWork(MoveTemp(work), InFlight));
+}
+
+void FTG_TileScheduler::Complete(FVector2D coord, TFunction<void()> commit)
+{
+  FScopeLock lock(&CompletedLock);
+  FTG_TileCompletion& completion = Completed[Completed.AddDefaulted()];
+  completion.coord = coord;
+  completion.commit = MoveTemp(commit);
+  NumCompleted.Increment();
+}
+
+int FTG_TileScheduler::Commit(FVector2D center, double budgetSeconds)
+{
+  // Take the Tiles finished since the last frame
+  if (NumCompleted.GetValue() > 0) {
+    FScopeLock lock(&CompletedLock);
+    for (FTG_TileCompletion& completion : Completed) {
+      Pending.Add(MoveTemp(completion));
+    }
+    Completed.Reset();
+    NumCompleted.Reset();
+  }
+
+  if (Pending.Num() == 0) {
+    return 0;
+  }
+
+  // Nearest Tiles first, the last ones are popped
+  Pending.Sort([center](const FTG_TileCompletion& A, const FTG_TileCompletion& B) {
+    return FVector2D::DistSquared(A.coord, center) > FVector2D::DistSquared(B.coord, center);
+  });
+
+  double endTime = FPlatformTime::Seconds() + budgetSeconds;
+  int committed = 0;
+  do {
+    FTG_TileCompletion completion = Pending.Pop(false);
+    completion.commit();
+    committed++;
+  } while (Pending.Num() > 0 && (budgetSeconds <= 0.0 || FPlatformTime::Seconds() < endTime));
+
+  return committed;
+}
+
+bool FTG_TileScheduler::IsQueued(FVector2D coord) const
+{
+  return QueuedCoords.Contains(coord);
+}
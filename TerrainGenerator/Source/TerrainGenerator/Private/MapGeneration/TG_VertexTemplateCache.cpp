@@ -0,0 +1,45 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#include "TG_VertexTemplateCache.h"
+#include "Misc/ScopeLock.h"
+
+FTG_VertexTemplateCache& FTG_VertexTemplateCache::Get()
+{
+  static FTG_VertexTemplateCache Cache;
+  return Cache;
+}
+
+FTG_VertexTemplatePtr FTG_VertexTemplateCache::FindOrBuild(int lineSize, float spacing, float textureScale)
+{
+  FKey key = { lineSize, spacing, textureScale };
+
+  FScopeLock ScopeLock(&Lock);
+
+  if (FTG_VertexTemplatePtr* cached = Templates.Find(key)) {
+    return *cached;
+  }
+
+  TSharedPtr<FTG_VertexTemplate, ESPMode::ThreadSafe> built = MakeShareable(new FTG_VertexTemplate());
+  built->Positions.SetNumUninitialized(lineSize * lineSize);
+  built->UV.SetNumUninitialized(lineSize * lineSize);
+  built->UVHalf.SetNumUninitialized(lineSize * lineSize);
+
+  for (int y = 0; y < lineSize; y++) {
+    for (int x = 0; x < lineSize; x++) {
+      int index = x + y * lineSize;
+      built->Positions[index] = FVector(x * spacing, y * spacing, 0.f);
+      built->UV[index] = FVector2D(x / textureScale, y / textureScale);
+      built->UVHalf[index] = FVector2DHalf(built->UV[index]);
+    }
+  }
+
+  FTG_VertexTemplatePtr vertexTemplate = built;
+  Templates.Add(key, vertexTemplate);
+  return vertexTemplate;
+}
+
+void FTG_VertexTemplateCache::Reset()
+{
+  FScopeLock ScopeLock(&Lock);
+  Templates.Reset();
+}
@@ -0,0 +1,202 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#include "TG_WorldPack.h"
+#include "TG_TileCache.h"
+#include "TG_TileBuilder.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/FileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/ScopeLock.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogWorldPack, Log, All);
+
+/* Writer */
+FTG_WorldPackWriter::~FTG_WorldPackWriter()
+{
+  // Unfinished pack
+  if (Writer.IsValid()) {
+    Writer.Reset();
+    IFileManager::Get().Delete(*TempPath, false, false, true);
+  }
+}
+
+bool FTG_WorldPackWriter::Open(const FString& path, const FTG_GenerationParams& params, int maxTiles)
+{
+  Path = path;
+  TempPath = path + TEXT(".tmp");
+  Writer.Reset(IFileManager::Get().CreateFileWriter(*TempPath));
+  if (!Writer.IsValid()) {
+    UE_LOG(LogWorldPack, Error, TEXT("Could not create the World Pack %s"), *TempPath);
+    return false;
+  }
+
+  FMemory::Memzero(Header);
+  Header.Magic = FTG_WorldPackHeader::PackMagic;
+  Header.Version = FTG_WorldPackHeader::PackVersion;
+  Header.SettingsHash = params.SettingsHash;
+  Header.Seed = params.Seed;
+  Header.IndexOffset = sizeof(FTG_WorldPackHeader);
+
+  MaxTiles = maxTiles;
+  Entries.Reset(maxTiles);
+
+  // Room for the header and the index, written on Close
+  Cursor = Header.IndexOffset + (int64)maxTiles * sizeof(FTG_WorldPackEntry);
+  return true;
+}
+
+bool FTG_WorldPackWriter::AddTile(int x, int y, const TArray<uint8>& chunk)
+{
+  FScopeLock ScopeLock(&Lock);
+  if (!Writer.IsValid() || Entries.Num() >= MaxTiles) {
+    return false;
+  }
+
+  FTG_WorldPackEntry entry;
+  entry.TileX = x;
+  entry.TileY = y;
+  entry.Offset = Align(Cursor, (int64)FTG_WorldPackHeader::ChunkAlignment);
+  entry.Size = chunk.Num();
+
+  Writer->Seek(entry.Offset);
+  Writer->Serialize(const_cast<uint8*>(chunk.GetData()), chunk.Num());
+  Cursor = entry.Offset + entry.Size;
+
+  Entries.Add(entry);
+  return !Writer->IsError();
+}
+
+bool FTG_WorldPackWriter::Close()
+{
+  FScopeLock ScopeLock(&Lock);
+  if (!Writer.IsValid()) {
+    return false;
+  }
+
+  // Sorted so the index reads in the same order as the world
+  Entries.Sort([](const FTG_WorldPackEntry& A, const FTG_WorldPackEntry& B) {
+    return A.TileY != B.TileY ? A.TileY < B.TileY : A.TileX < B.TileX;
+  });
+  Header.NumTiles = Entries.Num();
+
+  Writer->Seek(0);
+  Writer->Serialize(&Header, sizeof(Header));
+  Writer->Serialize(Entries.GetData(), Entries.Num() * sizeof(FTG_WorldPackEntry));
+
+  bool success = !Writer->IsError();
+  success &= Writer->Close();
+  Writer.Reset();
+
+  if (!success || !IFileManager::Get().Move(*Path, *TempPath, true, true)) {
+    UE_LOG(LogWorldPack, Error, TEXT("Could not write the World Pack %s"), *Path);
+    IFileManager::Get().Delete(*TempPath, false, false, true);
+    return false;
+  }
+
+  UE_LOG(LogWorldPack, Log, TEXT("World Pack %s: %d Tiles, %lld bytes"), *Path, Entries.Num(), Cursor);
+  return true;
+}
+
+/* Reader */
+FTG_WorldPack::~FTG_WorldPack()
+{
+  MappedRegion.Reset();
+  MappedFile.Reset();
+}
+
+TSharedPtr<FTG_WorldPack, ESPMode::ThreadSafe> FTG_WorldPack::Open(const FString& path)
+{
+  TSharedPtr<FTG_WorldPack, ESPMode::ThreadSafe> pack = MakeShareable(new FTG_WorldPack());
+  pack->Path = path;
+
+  IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+  if (!platformFile.FileExists(*path)) {
+    UE_LOG(LogWorldPack, Warning, TEXT("World Pack %s not found"), *path);
+    return nullptr;
+  }
+
+  // Map the whole file, nothing is read until a Tile is used
+  pack->MappedFile.Reset(platformFile.OpenMapped(*path));
+  if (pack->MappedFile.IsValid()) {
+    pack->MappedRegion.Reset(pack->MappedFile->MapRegion());
+  }
+
+  // Header and index
+  TArray<uint8> headerBytes;
+  const uint8* data = nullptr;
+  int64 size = 0;
+  if (pack->MappedRegion.IsValid()) {
+    data = pack->MappedRegion->GetMappedPtr();
+    size = pack->MappedRegion->GetMappedSize();
+  }
+  else {
+    pack->File.Reset(platformFile.OpenRead(*path));
+    if (!pack->File.IsValid()) {
+      return nullptr;
+    }
+    size = pack->File->Size();
+    headerBytes.SetNumUninitialized(FMath::Min<int64>(size, sizeof(FTG_WorldPackHeader)));
+    pack->File->Read(headerBytes.GetData(), headerBytes.Num());
+    data = headerBytes.GetData();
+  }
+
+  if (size < (int64)sizeof(FTG_WorldPackHeader)) {
+    UE_LOG(LogWorldPack, Warning, TEXT("World Pack %s is not valid"), *path);
+    return nullptr;
+  }
+  FMemory::Memcpy(&pack->Header, data, sizeof(FTG_WorldPackHeader));
+
+  const FTG_WorldPackHeader& header = pack->Header;
+  int64 indexEnd = header.IndexOffset + (int64)header.NumTiles * sizeof(FTG_WorldPackEntry);
+  if (header.Magic != FTG_WorldPackHeader::PackMagic || header.Version != FTG_WorldPackHeader::PackVersion || indexEnd > size) {
+    UE_LOG(LogWorldPack, Warning, TEXT("World Pack %s is not valid"), *path);
+    return nullptr;
+  }
+
+  TArray<FTG_WorldPackEntry> entries;
+  entries.SetNumUninitialized(header.NumTiles);
+  if (pack->MappedRegion.IsValid()) {
+    FMemory::Memcpy(entries.GetData(), data + header.IndexOffset, header.NumTiles * sizeof(FTG_WorldPackEntry));
+  }
+  else {
+    pack->File->Seek(header.IndexOffset);
+    pack->File->Read((uint8*)entries.GetData(), header.NumTiles * sizeof(FTG_WorldPackEntry));
+  }
+
+  pack->Index.Reserve(entries.Num());
+  for (const FTG_WorldPackEntry& entry : entries) {
+    if (entry.Offset + entry.Size <= (uint64)size) {
+      pack->Index.Add(FIntPoint(entry.TileX, entry.TileY), entry);
+    }
+  }
+
+  UE_LOG(LogWorldPack, Log, TEXT("World Pack %s: %d Tiles (%s)"), *path, pack->Index.Num(), pack->MappedRegion.IsValid() ? TEXT("mapped") : TEXT("file"));
+  return pack;
+}
+
+bool FTG_WorldPack::Contains(int x, int y) const
+{
+  return Index.Contains(FIntPoint(x, y));
+}
+
+bool FTG_WorldPack::Load(const FTG_GenerationParams& params, int x, int y, FRuntimeMeshBuilder& mesh, FTG_TileBuildResult& result) const
+{
+  const FTG_WorldPackEntry* entry = Index.Find(FIntPoint(x, y));
+  if (entry == nullptr) {
+    return false;
+  }
+
+  if (MappedRegion.IsValid()) {
+    return FTG_TileCache::ReadChunk(params, x, y, MappedRegion->GetMappedPtr() + entry->Offset, entry->Size, mesh, result);
+  }
+
+  TArray<uint8> chunk;
+  chunk.SetNumUninitialized(entry->Size);
+  {
+    FScopeLock ScopeLock(&FileLock);
+    if (!File->Seek(entry->Offset) || !File->Read(chunk.GetData(), chunk.Num())) {
+      return false;
+    }
+  }
+  return FTG_TileCache::ReadChunk(params, x, y, chunk.GetData(), chunk.Num(), mesh, result);
+}
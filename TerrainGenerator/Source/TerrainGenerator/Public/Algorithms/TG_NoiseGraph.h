@@ -0,0 +1,180 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TG_PerlinNoise.h"
+#include "TG_NoiseGraph.generated.h"
+
+UENUM(BlueprintType)
+enum class NoiseNodeType : uint8 {
+  /* Sources, sampled at the terrain position or at the Coords of a Domain Warp */
+  // fBm of Perlin noise (lacunarity 2 and gain 0.5 is octaveNoise)
+  NoiseNode_Perlin      UMETA(DisplayName = "Perlin"),
+  NoiseNode_Simplex     UMETA(DisplayName = "Simplex"),
+  NoiseNode_Value       UMETA(DisplayName = "Value"),
+  // Distance to the nearest feature point (Worley F1)
+  NoiseNode_Cellular    UMETA(DisplayName = "Cellular"),
+  // Sharp crests: (1 - |perlin|)^2 per octave
+  NoiseNode_Ridged      UMETA(DisplayName = "Ridged"),
+  // Round hills: 2 * |perlin| - 1 per octave
+  NoiseNode_Billow      UMETA(DisplayName = "Billow"),
+  // Erosion-like fBm: every octave is damped by the slope of the octaves below it (flat valleys, detailed crests)
+  NoiseNode_Eroded      UMETA(DisplayName = "Eroded"),
+  NoiseNode_Constant    UMETA(DisplayName = "Constant"),
+
+  /* Coordinates: position + (InputA, InputB) * strength, used by the Coords of other nodes */
+  NoiseNode_DomainWarp  UMETA(DisplayName = "Domain Warp"),
+
+  /* Operators */
+  NoiseNode_Add         UMETA(DisplayName = "Add"),
+  NoiseNode_Multiply    UMETA(DisplayName = "Multiply"),
+  // InputA * scale + bias
+  NoiseNode_ScaleBias   UMETA(DisplayName = "Scale Bias"),
+  // InputA below threshold, InputB above it, by the value of InputC (blended over falloff)
+  NoiseNode_Select      UMETA(DisplayName = "Select"),
+  NoiseNode_Clamp       UMETA(DisplayName = "Clamp"),
+  // Piecewise linear remap of InputA through curvePoints (X = input, Y = output)
+  NoiseNode_Curve       UMETA(DisplayName = "Curve"),
+  // InputA quantized to steps levels, smoothness 0 = flat terraces, 1 = smooth ramps
+  NoiseNode_Terrace     UMETA(DisplayName = "Terrace"),
+};
+
+USTRUCT(BlueprintType)
+struct FNoiseGraphNode {
+  GENERATED_BODY()
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph")
+    NoiseNodeType type = NoiseNodeType::NoiseNode_Perlin;
+
+  /* Inputs: index of an earlier node of the graph (-1 = none) */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Inputs")
+    int inputA = -1;
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Inputs")
+    int inputB = -1;
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Inputs")
+    int inputC = -1;
+  /* Domain Warp node giving the sample position (-1 = terrain position) */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Inputs")
+    int coords = -1;
+
+  /* Sources */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Source", meta = (ClampMin = "0.0"))
+    float frequency = 1.f;
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Source", meta = (ClampMin = "1", ClampMax = "16"))
+    int octaves = 1;
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Source")
+    float lacunarity = 2.f;
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Source")
+    float gain = 0.5f;
+  /* Added to the Seed of the terrain, nodes with the same offset share the permutation */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Source")
+    int seedOffset = 0;
+
+  /* Scale Bias (the Constant is the bias and the Domain Warp strength is the scale) */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Operator")
+    float scale = 1.f;
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Operator")
+    float bias = 0.f;
+
+  /* Clamp */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Operator")
+    float minValue = 0.f;
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Operator")
+    float maxValue = 1.f;
+
+  /* Select */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Operator")
+    float threshold = 0.5f;
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Operator", meta = (ClampMin = "0.0"))
+    float falloff = 0.f;
+
+  /* Terrace */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Operator", meta = (ClampMin = "1"))
+    int steps = 8;
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Operator", meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
+    float smoothness = 0.f;
+
+  /* Curve */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph|Operator")
+    TArray<FVector2D> curvePoints;
+};
+
+/*
+  Terrain height as a graph of nodes, replaces the fBm of the Terrain Generator.
+  The nodes only use earlier nodes as inputs, the output is in the same range as octaveNoise0_1
+  (Perlin with the Octaves of the terrain followed by a Scale Bias of 0.5, 0.5 is the default terrain).
+*/
+USTRUCT(BlueprintType)
+struct FNoiseGraph {
+  GENERATED_BODY()
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph")
+    TArray<FNoiseGraphNode> nodes;
+
+  /* Node with the terrain height (-1 = last node) */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NoiseGraph")
+    int output = -1;
+};
+
+/* One step of the tape, operands are registers (rows of samples) */
+struct FTG_NoiseInstruction {
+  NoiseNodeType Op;
+  uint8 Padding[3];
+  // Output registers (Y only for the Domain Warp)
+  uint16 OutX;
+  uint16 OutY;
+  uint16 A;
+  uint16 B;
+  uint16 C;
+  // Sample position of the sources
+  uint16 CoordX;
+  uint16 CoordY;
+  uint16 Noise;
+  int32 Octaves;
+  float Frequency;
+  float Lacunarity;
+  float Gain;
+  float Params[4];
+  int32 CurveStart;
+  int32 CurveCount;
+};
+
+/*
+  FNoiseGraph compiled once into a flat tape of instructions over registers.
+  Only the nodes reaching the output are kept and the registers are reused once their last reader ran.
+  The grid is evaluated one row at a time, so every instruction runs over a whole row before the next one.
+  Read-only after Compile, shared by the workers.
+*/
+class TERRAINGENERATOR_API FTG_NoiseProgram
+{
+public:
+  /* Returns nullptr and the reason in error if the graph is not valid */
+  static TSharedPtr<const FTG_NoiseProgram, ESPMode::ThreadSafe> Compile(const FNoiseGraph& graph, int32 seed, FString& error);
+
+  /* Same layout as TG_PerlinNoise::FillHeightGrid, (x, y) in noise space */
+  void EvaluateGrid(double originX, double originY, double step, int32 width, int32 height, float* out) const;
+
+  float Evaluate(double x, double y) const;
+
+  /* Changes with the instructions, the constants and the permutations */
+  uint64 GetHash() const;
+
+  int32 NumInstructions() const { return Tape.Num(); }
+  int32 NumRegisters() const { return Registers; }
+
+private:
+  FTG_NoiseProgram() {}
+
+  void EvaluateRow(double originX, double y, double step, int32 width, float* registers) const;
+  void EvaluateSource(const FTG_NoiseInstruction& instruction, double originX, double originY, double step,
+    int32 width, const float* registers, float* out) const;
+
+  TArray<FTG_NoiseInstruction> Tape;
+  TArray<FVector2D> CurvePoints;
+  TArray<TG_PerlinNoise<float>, TAlignedHeapAllocator<64>> Noises;
+  int32 Registers = 0;
+  uint16 Output = 0;
+};
+
+typedef TSharedPtr<const FTG_NoiseProgram, ESPMode::ThreadSafe> FTG_NoiseProgramPtr;
@@ -4,23 +4,66 @@
 
 #include "CoreMinimal.h"
 
+/*
+  Perlin noise computed in T (float or double).
+  The positions are taken in double and split in lattice cell (exact) + offset inside the cell,
+  only the offset is converted to T, so the float noise keeps its precision far from the origin.
+  TG_PerlinNoise<float> generates the Tiles, TG_PerlinNoise<double> is the reference to validate it.
+  The permutation is stored inline, so the noise is trivially copyable and copies without allocating.
+*/
+template <typename T>
 class TERRAINGENERATOR_API TG_PerlinNoise
 {
 public:
-  // Generate a new permutation vector based on the value of seed
   TG_PerlinNoise();
 
+  // Generate a new permutation vector based on the value of seed
+  // (a shuffle of 0..255 driven by its own FRandomStream, the same on every platform)
   void setNoiseSeed(const int32& newSeed);
 
-  double noise(double x = 0.0, double y = 0.0, double z = 0.0);
-  double noise0_1(double x = 0.0, double y = 0.0, double z = 0.0);
-  double octaveNoise(double x = 0.0, double y = 0.0, double z = 0.0, int32 octaves = 1);
-  double octaveNoise0_1(double x = 0.0, double y = 0.0, double z = 0.0, int32 octaves = 1);
+  // Hash of the permutation, changes with the seed and with the way it is generated
+  uint32 GetPermutationHash() const;
+
+  T noise(double x = 0.0, double y = 0.0, double z = 0.0) const;
+  T noise0_1(double x = 0.0, double y = 0.0, double z = 0.0) const;
+  T octaveNoise(double x = 0.0, double y = 0.0, double z = 0.0, int32 octaves = 1) const;
+  T octaveNoise0_1(double x = 0.0, double y = 0.0, double z = 0.0, int32 octaves = 1) const;
+
+  // noise(x, y, 0) and its analytic partial derivatives dNdx, dNdy
+  T noiseDerivatives(double x, double y, T& dNdx, T& dNdy) const;
+  // octaveNoise(x, y, 0, octaves) and its analytic partial derivatives summed over the octaves
+  T octaveNoiseDerivatives(double x, double y, int32 octaves, T& dNdx, T& dNdy) const;
+
+  // 2D noises of the noise graph, they share the permutation of the seed
+  // Simplex noise in [-1, 1]
+  T simplexNoise(double x, double y) const;
+  // Smoothly interpolated random lattice values in [-1, 1]
+  T valueNoise(double x, double y) const;
+  // Worley F1: distance to the nearest feature point (one per lattice cell), about [0, 1]
+  T cellularNoise(double x, double y) const;
+
+  // Fill a row-major width * height grid with octaveNoise(originX + x * step, originY + y * step, 0.0, octaves).
+  // The vector kernel evaluates 4 samples per lane group in float and matches the scalar
+  // double path within 1e-5 (absolute). Set tg.Noise.VectorKernel 0 to use the scalar path.
+  // The double noise always uses the scalar path.
+  // outDX and outDY (optional, both or none) get the analytic derivatives of every sample along x and y.
+  void FillHeightGrid(double originX, double originY, double step, int32 width, int32 height, int32 octaves, float* out,
+    float* outDX = nullptr, float* outDY = nullptr) const;
 
 private:
-  TArray<int32> perm;
-  double Fade(double t);
-  double Lerp(double t, double a, double b);
-  double Grad(int32 hash, double x, double y, double z);
+  // 256 shuffled values repeated twice so perm[perm[x] + y + 1] never wraps, starts on a cache line
+  MS_ALIGN(64) uint8 perm[512] GCC_ALIGN(64);
+
+  T Fade(T t) const;
+  T FadeDerivative(T t) const;
+  T Lerp(T t, T a, T b) const;
+  T Grad(int32 hash, T x, T y, T z) const;
+
+  // Noise of the lattice cell unit (wrapped to the period) at the offset sub inside it
+  T LatticeNoise(int32 unitX, int32 unitY, int32 unitZ, T subX, T subY, T subZ) const;
+
+  // Batched z = 0 slice of octaveNoise for a single row
+  void FillHeightRow(double originX, double y, double step, int32 width, int32 octaves, float* out, float* outDX, float* outDY) const;
+  void FillHeightRowScalar(double originX, double y, double step, int32 width, int32 octaves, float* out, float* outDX, float* outDY) const;
 
 };
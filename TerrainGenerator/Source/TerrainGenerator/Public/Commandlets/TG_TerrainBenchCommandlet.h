@@ -0,0 +1,29 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TG_TerrainBenchCommandlet.generated.h"
+
+/*
+  Microbenchmarks of the terrain generation hot paths, without a world or rendering.
+  UE4Editor-Cmd <Project> -run=TG_TerrainBench [options]
+    -Output=<file>     JSON results (default Saved/Benchmarks/TerrainBench.json)
+    -Filter=<text>     Only the benchmarks whose name contains text
+    -MinTime=<s>       Minimum measured time of every benchmark (default 0.25)
+    -Seed=<n>          Seed of the noise (default 3140)
+  Every benchmark has a stable name (group/function/variant) so the runs can be diffed.
+  Returns 1 when an accuracy check fails (the float noise grid is over 1e-5 from the double path
+  or from the scalar float path, or its derivatives are wrong).
+*/
+UCLASS()
+class TERRAINGENERATOR_API UTG_TerrainBenchCommandlet : public UCommandlet
+{
+  GENERATED_BODY()
+
+public:
+  UTG_TerrainBenchCommandlet();
+
+  virtual int32 Main(const FString& Params) override;
+};
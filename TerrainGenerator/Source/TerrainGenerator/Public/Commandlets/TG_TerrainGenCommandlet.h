@@ -0,0 +1,31 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TG_TerrainGenCommandlet.generated.h"
+
+/*
+  Generates a region of Tiles without a world, a player or rendering.
+  UE4Editor-Cmd <Project> -run=TG_TerrainGen [options]
+    -Generator=<class>    Blueprint class of ATG_TerrainGenerator with the settings (default settings if missing)
+    -Seed= -Octaves= -Amplitude= -Frequency= -TileSize=   Override the settings
+    -Tiles=<N>            Region of N x N Tiles (default 8)
+    -OriginX= -OriginY=   First Tile of the region (default 0, 0)
+    -SingleThread         Generate on one core
+    -UseCache             Read and write the Tile Cache
+    -HeightmapRaw=<file>  Heightmap of the region, raw 16-bit little endian
+    -HeightmapPNG=<file>  Heightmap of the region, 16-bit grayscale PNG
+    -Pack=<file>          Write the region as a World Pack
+*/
+UCLASS()
+class TERRAINGENERATOR_API UTG_TerrainGenCommandlet : public UCommandlet
+{
+  GENERATED_BODY()
+
+public:
+  UTG_TerrainGenCommandlet();
+
+  virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,112 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "TG_TileSettings.h"
+#include "TG_BiomeSettings.h"
+#include "TG_VertexTemplateCache.h"
+
+/* Algorithms */
+#include "TG_PerlinNoise.h"
+#include "TG_NoiseGraph.h"
+
+#include "CoreMinimal.h"
+
+class FTG_WorldPack;
+
+/*
+  Plain copies of the Biome settings. The workers read them while the GC can run,
+  so the UObjects are only kept as weak pointers, resolved on the game thread.
+*/
+struct TERRAINGENERATOR_API FTG_AssetParams {
+  float probability = 0.f;
+  bool collision = false;
+  bool randomRotation = false;
+  bool randomScale = false;
+  FVector maxRandomScale = FVector::OneVector;
+  bool hasMesh = false;
+  TWeakObjectPtr<UStaticMesh> mesh;
+
+  FTG_AssetParams() {}
+  explicit FTG_AssetParams(const FAssetSettings& settings);
+};
+
+struct TERRAINGENERATOR_API FTG_BiomeParams {
+  float minHeight = 0.f;
+  float maxHeight = 0.f;
+  TArray<FColor> vertexColors;
+  FTG_AssetParams asset;
+
+  FTG_BiomeParams() {}
+  explicit FTG_BiomeParams(const FBiomeSettings& settings);
+};
+
+/*
+  Copy of the ATG_TerrainGenerator settings used to build the Tiles.
+  Built on the game thread and shared read-only with the workers.
+*/
+struct TERRAINGENERATOR_API FTG_GenerationParams {
+  // Heap copy aligned for perlinNoiseTerrain (the global operator new only aligns to 16 bytes)
+  static TSharedPtr<FTG_GenerationParams, ESPMode::ThreadSafe> Allocate();
+
+  /* Algorithm */
+  int Seed = 0;
+  double Amplitude = 1.0;
+  double Frequency = 1.0;
+  int Octaves = 1;
+  TG_PerlinNoise<float> perlinNoiseTerrain;
+  // Compiled Noise Graph, replaces the fBm of perlinNoiseTerrain when set
+  FTG_NoiseProgramPtr noiseProgram;
+
+  // Height used to normalize the terrain for Biomes, Assets and Water (see ComputeMaxHeight)
+  float maxHeight = 0.f;
+
+  /* Tile */
+  FTileSettings tileSettings;
+  // XY and UV of the full resolution grid, shared by every Tile
+  FTG_VertexTemplatePtr vertexTemplate;
+  bool seamlessNormals = true;
+  // Normals from the derivatives of the noise instead of the differences of the HeightField
+  bool analyticNormals = true;
+  TileVertexFormat vertexFormat = TileVertexFormat::TileVertexFormat_Full;
+  FName TileName;
+  float maxDistanceForAssets = 0.f;
+
+  /* Biomes */
+  bool useVertexColor = false;
+  bool useHeightMap = false;
+  bool spawnAssets = false;
+  TArray<FTG_BiomeParams> biomeList;
+  TWeakObjectPtr<UMaterialInterface> defaultMaterial;
+
+  /* Cache */
+  bool useTileCache = false;
+  // Hash of every setting that changes the generated Tiles (see FTG_TileCache)
+  uint64 SettingsHash = 0;
+  // Baked Tiles to stream instead of generating them (only set when it was baked with these settings)
+  TSharedPtr<const FTG_WorldPack, ESPMode::ThreadSafe> worldPack;
+
+  /* Water */
+  bool useWater = false;
+  float waterHeight = 0.f;
+  TWeakObjectPtr<UStaticMesh> water;
+  TWeakObjectPtr<UMaterialInterface> waterMaterial;
+
+  // Terrain noise of a lineSize * lineSize grid starting at world (x, y), same values as GetAlgorithmValue.
+  // outDX and outDY (only with HasAnalyticNormals) get the slope of every value along world x and y
+  void GetAlgorithmGrid(double x, double y, double spacing, int lineSize, float* out,
+    float* outDX = nullptr, float* outDY = nullptr) const;
+
+  // The terrain noise gives its derivatives (a Noise Graph does not)
+  bool HasAnalyticNormals() const;
+
+  // Highest terrain height for this Seed and settings, it does not depend on which Tiles exist.
+  // It is the highest of a dense sampling, not a bound: a higher vertex is clamped to 1 by the
+  // normalization (GetNormalizedHeight). Sampled once per noise settings, then cached
+  float ComputeMaxHeight() const;
+
+  // Hash of the settings that change the heights, normals, colors or assets of a Tile
+  uint64 ComputeSettingsHash() const;
+};
+
+typedef TSharedPtr<const FTG_GenerationParams, ESPMode::ThreadSafe> FTG_GenerationParamsPtr;
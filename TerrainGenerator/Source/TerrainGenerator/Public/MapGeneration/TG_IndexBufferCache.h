@@ -0,0 +1,44 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "TG_TileLOD.h"
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+/* Immutable triangle list shared by every Tile with the same grid */
+struct FTG_IndexBuffer {
+  TArray<int32> Indices;
+  // Same triangles for the sections with 16-bit indices (empty when the grid does not fit)
+  TArray<uint16> Indices16;
+};
+
+typedef TSharedPtr<const FTG_IndexBuffer, ESPMode::ThreadSafe> FTG_IndexBufferPtr;
+
+/*
+  Process-wide cache of the grid triangles, keyed by vertices per line and stitch.
+  The topology of a Tile only depends on the grid, so all the Tiles reference the same
+  arrays. The buffers are kept until Reset (new generation settings), so a stitch no Tile
+  uses right now is not built again when a Tile needs it.
+*/
+class TERRAINGENERATOR_API FTG_IndexBufferCache
+{
+public:
+  static FTG_IndexBufferCache& Get();
+
+  /* Triangles of a grid with lodLineSize vertices per line (built the first time, any thread) */
+  FTG_IndexBufferPtr FindOrBuild(int lodLineSize, const FTG_LODStitch& stitch);
+
+  /* Number of buffers cached */
+  int Num();
+
+  /* Drop every buffer, the ones still referenced by Tiles stay alive until released */
+  void Reset();
+
+private:
+  static uint64 MakeKey(int lodLineSize, const FTG_LODStitch& stitch);
+
+  FCriticalSection Lock;
+  TMap<uint64, FTG_IndexBufferPtr> Buffers;
+};
@@ -0,0 +1,23 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+/* stat TerrainGenerator: every stage of the Tile lifecycle, on the workers and on the game thread */
+DECLARE_STATS_GROUP(TEXT("TerrainGenerator"), STATGROUP_TerrainGenerator, STATCAT_Advanced);
+
+/*
+  Named events around the big regions (build, commit, streaming), seen by external profilers.
+  Off by default, build with TG_TRACE_EVENTS=1 to emit them.
+*/
+#ifndef TG_TRACE_EVENTS
+#define TG_TRACE_EVENTS 0
+#endif
+
+#if TG_TRACE_EVENTS
+#define TG_TRACE_SCOPE(Name) SCOPED_NAMED_EVENT(Name, FColor::Emerald)
+#else
+#define TG_TRACE_SCOPE(Name)
+#endif
@@ -3,11 +3,15 @@
 #pragma once
 
 #include "TG_Tile.h"
+#include "TG_TileScheduler.h"
+#include "TG_GenerationParams.h"
+#include "TG_WorldPack.h"
 #include "TG_TileSettings.h"
 #include "TG_BiomeSettings.h"
 
 /* Algorithms */
 #include "TG_PerlinNoise.h"
+#include "TG_NoiseGraph.h"
 
 #include "GameFramework/Character.h"
 #include <Components/InstancedStaticMeshComponent.h>
@@ -31,7 +35,9 @@ class TERRAINGENERATOR_API ATG_TerrainGenerator : public AInfo
 public:	
 	ATG_TerrainGenerator();
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
+  virtual bool ShouldTickIfViewportsOnly() const override;
 
 #if WITH_EDITOR
   void OnConstruction(const FTransform& Transform) override;
@@ -45,6 +51,39 @@ public:
 
   UFUNCTION()
     void CreateTile(int x, int y);
+
+  /* Add the Tile to the generation queue, it is created when a worker is free */
+  UFUNCTION()
+    void QueueTile(int x, int y);
+
+  /* Move the streaming window to the Tile of the player: queue the new Tiles and update the visibility */
+  UFUNCTION()
+    void UpdateStreaming(FVector2D currentTile);
+
+  /* Visibility a Tile should have from the current streaming window */
+  UFUNCTION()
+    void GetTileVisibility(int x, int y, bool& terrain, bool& assets);
+
+  /* Level of detail of a Tile from the distance to the player */
+  UFUNCTION()
+    int GetLODForCoords(int x, int y);
+  /* Level of detail of a Tile and how it must be stitched to its neighbours */
+  void GetTileLOD(int x, int y, int& lod, FTG_LODStitch& stitch);
+
+  /* Release the least recently used Tiles out of the window until the resident budget is met */
+  UFUNCTION()
+    void EvictTiles();
+
+  /* Start the queued Tiles nearest to the player */
+  UFUNCTION()
+    void DispatchTiles();
+
+  /* Apply the Tiles finished by the workers, nearest first, within commitBudgetMs */
+  UFUNCTION()
+    void CommitTiles();
+
+  /* Build the Tile on a worker with the current GenerationParams, CommitTiles applies it on the game thread */
+  void LaunchTile(ATG_Tile* tile, int tileID, int x, int y);
   
   UFUNCTION()
     void UpdateTerrain();
@@ -65,6 +104,20 @@ public:
   UFUNCTION()
     double GetSpecifiedAlgorithmValue(PerlinType type, double x, double y, double amplitude = 1.0, double frequency = 1.0, int octaves = 1);
 
+  /* Generate every Tile of the PreBake world on all the cores and write them to the World Pack */
+  UFUNCTION()
+    bool BakeWorldPack();
+
+  /* Full path of the World Pack file */
+  UFUNCTION()
+    FString GetWorldPackPath() const;
+
+  /* Snapshot of the settings for the workers (game thread) */
+  FTG_GenerationParamsPtr BuildGenerationParams();
+
+  /* Settings used by the Tiles generated from now on (set by InitAlgorithm) */
+  FTG_GenerationParamsPtr GetGenerationParams() const { return GenerationParams; }
+
   /*
    CONFIGURABLE VARIABLES
   */
@@ -83,10 +136,33 @@ public:
   UPROPERTY(EditAnywhere, Category = "TerrainGenerator")
     int Octaves = 8;
 
+  // Build the terrain height with the Noise Graph instead of the Perlin fBm (Octaves is not used)
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|NoiseGraph")
+    bool useNoiseGraph = false;
+  // Nodes evaluated at the terrain position scaled by Frequency, the output is multiplied by the Amplitude
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|NoiseGraph", Meta = (EditCondition = "useNoiseGraph"))
+    FNoiseGraph noiseGraph;
+
   // Settings of the Tile
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Tile")
     FTileSettings tileSettings;
 
+  // Sample the noise one vertex beyond the tile border so the normals match across tile seams
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Tile")
+    bool seamlessNormals = true;
+
+  // Exact normals and tangents from the derivatives of the noise, computed with the heights (not with a Noise Graph)
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Tile")
+    bool analyticNormals = true;
+
+  // Layout of the vertex streams of the Tiles (the normals and tangents are always packed)
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Tile")
+    TileVertexFormat vertexFormat = TileVertexFormat::TileVertexFormat_Full;
+
+  // Keep the generated Tiles in Saved/TerrainCache and load them instead of generating them again
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Tile")
+    bool useTileCache = false;
+
   // List of the Tiles Created
   UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Tile|Lists")
     TMap<FVector2D, ATG_Tile*> TileMap;
@@ -143,6 +219,27 @@ public:
   UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Runtime|Infinite")
     int tVisibleInViewDst = 0;
 
+  // Stream the Tiles from the baked World Pack, the ones outside of it are generated
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Runtime", Meta = (EditCondition = "useRuntime"))
+    bool useWorldPack = false;
+
+  // Threads generating Tiles (0 = number of cores - 1)
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Runtime|Workers", meta = (ClampMin = "0"))
+    int generationWorkers = 0;
+  // Max Tiles started per frame
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Runtime|Workers", meta = (ClampMin = "1"))
+    int maxTilesPerFrame = 4;
+  // Game thread time spent applying finished Tiles per frame in ms, at least one Tile is applied (0 = no limit)
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Runtime|Workers", meta = (ClampMin = "0"))
+    float commitBudgetMs = 4.f;
+
+  // Max Tiles kept in memory in Infinite mode (0 = twice the Tiles in view)
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Runtime|Infinite", meta = (ClampMin = "0"))
+    int maxResidentTiles = 0;
+  // Max memory used by the Tiles in Infinite mode in MB (0 = no limit)
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Runtime|Infinite", meta = (ClampMin = "0"))
+    int maxResidentMemoryMB = 1024;
+
   /*
     PRE BACK OPTION
   */
@@ -155,6 +252,12 @@ public:
   // Bool to destroy the world in Editor Mode
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|PreBake", Meta = (EditCondition = "usePreBake"))
     bool DestroyWorld = false;
+  // CreateWorld bakes the Tiles to the World Pack instead of spawning them in the level
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|PreBake", Meta = (EditCondition = "usePreBake"))
+    bool bakeWorldPack = false;
+  // World Pack file relative to the Content folder (add its folder to the non-asset directories to package it)
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|PreBake")
+    FString worldPackFile = TEXT("TerrainGenerator/World.tgpack");
 
   /*
     PATHS FOR EDITOR
@@ -169,25 +272,46 @@ public:
   /*
     DEBUG OPTIONS
   */
-  // DEPRECTED Option and need to be implemented in a future
-  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Debug")
-    bool DestroyTilesOutOfRange = false;
-
   // The Player
   UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "TerrainGenerator|Debug")
     ACharacter* player = nullptr;
   
+  // Height used to normalize the terrain, computed from the Seed in InitAlgorithm
   double maxHeight = 0.0;
 
 protected:
   UPROPERTY()
     bool generated = false;
 
+  // Tile of the player when the streaming window was updated
+  UPROPERTY()
+    FVector2D streamingCenter = FVector2D::ZeroVector;
+  UPROPERTY()
+    bool streamingStarted = false;
+
+  // Coords inside the streaming window
+  TSet<FVector2D> StreamingWindow;
+  // Incremented on every streaming update, Tiles inside the window are stamped with it
+  uint32 streamingEpoch = 0;
+
+  // Released Tiles waiting to be reused for new coords
   UPROPERTY()
-    TArray<ATG_Tile*> TileList;
+    TArray<ATG_Tile*> TilePool;
+
+  // ID of the next spawned Tile
+  UPROPERTY()
+    int nextTileId = 0;
+
+  FTG_TileScheduler TileScheduler;
+
+  // Settings used by the Tiles generated from now on
+  FTG_GenerationParamsPtr GenerationParams;
+
+  // Opened World Pack (useWorldPack)
+  FTG_WorldPackPtr WorldPack;
 
-  TG_PerlinNoise perlinNoiseTerrain;
-  TG_PerlinNoise perlinNoiseBiomes;
+  TG_PerlinNoise<float> perlinNoiseTerrain;
+  TG_PerlinNoise<float> perlinNoiseBiomes;
 
 private:
   UFUNCTION()
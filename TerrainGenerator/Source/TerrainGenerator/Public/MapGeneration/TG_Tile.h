@@ -3,8 +3,10 @@
 #pragma once
 
 #include "TG_TileSettings.h"
-#include "TG_MeshSettings.h"
 #include "TG_AssetSettings.h"
+#include "TG_TileBuilder.h"
+#include "TG_TileLOD.h"
+#include "TG_IndexBufferCache.h"
 #include "RuntimeMeshComponent.h"
 
 #include "CoreMinimal.h"
@@ -23,12 +25,23 @@ class TERRAINGENERATOR_API ATG_Tile : public AActor
 public:
   ATG_Tile();
 
-  UFUNCTION()
-    void Init(int tileID, int coordX, int coordY, FTileSettings tSettings, ATG_TerrainGenerator* manager);
+  /* Apply a Tile generated by FTG_TileBuilder (game thread) */
+  void Commit(FTG_TileBuildResult& result, ATG_TerrainGenerator* manager);
   UFUNCTION()
     void Update(int coordX, int coordY);
+  /* Set the visibility, only touching the components that change */
+  UFUNCTION()
+    void UpdateVisibility(bool terrain, bool assets);
+  /* Show the level of detail, building its section the first time it is needed */
+  void ApplyLOD(int lod, const FTG_LODStitch& stitch);
   UFUNCTION()
     bool DestroyTile();
+  /* Hide the Tile and free its buffers so it can be reused for other coords */
+  UFUNCTION()
+    void ReleaseTile();
+
+  /* Approximate memory held by this Tile (CPU buffers, render buffers and instances) */
+  SIZE_T GetResidentBytes() const;
 
   /* GETTER */
   UFUNCTION()
@@ -65,6 +78,11 @@ public:
     bool Generated = false;
   UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Tile")
     bool Visible = false;
+  UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Tile")
+    bool VisibleAsset = false;
+
+  UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Tile")
+    int CurrentLOD = -1;
 
   UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Tile")
     int TileID = -1;
@@ -77,6 +95,11 @@ public:
   UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Tile")
     float maxDistanceForAssets = 0.f;
 
+  // Streaming update where the Tile was last inside the window (for the LRU eviction)
+  uint32 LastUsed = 0;
+  // Incremented every time the Tile is launched or released, stale results are ignored
+  uint32 BuildSerial = 0;
+
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tile")
     URuntimeMeshComponent* RuntimeMesh;
 
@@ -87,37 +110,17 @@ public:
     TArray<UInstancedStaticMeshComponent*> InstancedList;
 
 protected:
-  /* Initialize all the Mesh values to DEFAULT value */
-  UFUNCTION()
-    void InitMeshToCreate();
-
-  /* Generate the Vertices on the Mesh with Algorithm result */
-  UFUNCTION()
-    void GenerateVertices();
-  UFUNCTION()
-    void GenerateTriangles();
-  UFUNCTION()
-    void GenerateNormalTangents(bool SmoothNormals);
-
-  /* Generate the Mesh with the values modified in other functions */
-  UFUNCTION()
-    void GenerateMesh(UMaterialInterface* material);
-
-  /* Update the Mesh with the values modified in other functions */
-  UFUNCTION()
-    void UpdateMesh(UMaterialInterface* material);
+  /* Generate the section of a level of detail (one section per level) */
+  void GenerateMesh(int lod, const FTG_LODStitch& stitch);
+  /* Create or update the section of a level with the packed streams */
+  void CommitSection(int lod, TSharedPtr<FRuntimeMeshBuilder> mesh, bool collision);
 
   /* Setup the Water settings*/
   UFUNCTION()
     void SetupWater(FTileSettings tSettings);
 
-  /* Setup the Biomes settings*/
-  UFUNCTION()
-    void SetupBiomes(FTileSettings tSettings);
-
-  /* Setup the Biomes settings*/
-  UFUNCTION()
-    void SetupAssets(FTileSettings tSettings);
+  /* Add the asset instances of every Biome */
+  void SetupAssets(const TArray<TArray<FTransform>>& assetTransforms);
 
   /* Set the Terrain Position on the middle the Tile */
   UFUNCTION()
@@ -126,8 +129,24 @@ protected:
   UFUNCTION()
     void setTileName(FName text);
 
-  // Perlin Value Array
-  TMap<FVector2D, double> ZPositions;
+  // Height of every vertex, row-major and indexed with GetValueIndexForCoordinates
+  TArray<float> HeightField;
+
+  // Settings the current mesh was generated with
+  FTG_GenerationParamsPtr GenerationParams;
+
+  // Stream layout of the sections (UV precision, index size and colors)
+  uint8 SectionsFormat = 0;
+
+  // Levels with a section up to date with the last Commit (bit per level)
+  uint32 LODSectionsBuilt = 0;
+  // Stitch every section was built with and its shared triangles
+  FTG_LODStitch LODStitches[FTG_TileLOD::MaxLODs];
+  FTG_IndexBufferPtr LODTriangles[FTG_TileLOD::MaxLODs];
+  // Size of the vertex streams and of one index of every section, in its actual layout
+  SIZE_T LODVertexBytes[FTG_TileLOD::MaxLODs] = {};
+  SIZE_T LODIndexSize[FTG_TileLOD::MaxLODs] = {};
+  FTG_LODStitch CurrentStitch;
 
 private:
   UPROPERTY()
@@ -136,6 +155,6 @@ private:
   UPROPERTY()
     FTileSettings tileSettings;
 
-  UPROPERTY()
-    FMeshSettings MeshToCreate;
+  // Packed vertex streams of every level of detail not uploaded yet (moved into the section when shown)
+  TArray<TSharedPtr<FRuntimeMeshBuilder>> PendingLODs;
 };
\ No newline at end of file
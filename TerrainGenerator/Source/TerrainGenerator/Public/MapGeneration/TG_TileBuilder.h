@@ -0,0 +1,118 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "TG_GenerationParams.h"
+#include "TG_TileLOD.h"
+#include "RuntimeMeshBuilder.h"
+
+#include "CoreMinimal.h"
+
+/* Seconds spent in every stage of a Tile build */
+struct FTG_TileBuildTimings {
+  double Init = 0.0;
+  double Load = 0.0;
+  double Vertices = 0.0;
+  double Normals = 0.0;
+  double Biomes = 0.0;
+  double Assets = 0.0;
+  double Save = 0.0;
+  double LODs = 0.0;
+
+  double Total() const {
+    return Init + Load + Vertices + Normals + Biomes + Assets + Save + LODs;
+  }
+
+  void Add(const FTG_TileBuildTimings& other) {
+    Init += other.Init;
+    Load += other.Load;
+    Vertices += other.Vertices;
+    Normals += other.Normals;
+    Biomes += other.Biomes;
+    Assets += other.Assets;
+    Save += other.Save;
+    LODs += other.LODs;
+  }
+};
+
+/* Everything a worker generates for one Tile, applied on the game thread by ATG_Tile::Commit */
+struct FTG_TileBuildResult {
+  int TileID = -1;
+  int TileX = 0;
+  int TileY = 0;
+
+  // Settings used to build the Tile
+  FTG_GenerationParamsPtr Params;
+
+  // Packed vertex streams of every level of detail, the full resolution first (no indices, they are shared)
+  TArray<TSharedPtr<FRuntimeMeshBuilder>> LODMeshes;
+
+  // Height of every vertex, row-major and indexed with GetValueIndexForCoordinates
+  TArray<float> HeightField;
+  float maxHeight = 0.f;
+
+  // Instances of the Biome assets, one list per Biome
+  TArray<TArray<FTransform>> AssetTransforms;
+
+  // Time of every stage
+  FTG_TileBuildTimings Timings;
+};
+
+/*
+  Generates the mesh of a Tile without touching any actor, so it can run on any thread.
+*/
+class TERRAINGENERATOR_API FTG_TileBuilder
+{
+public:
+  FTG_TileBuilder(const FTG_GenerationParams& InParams, FTG_TileBuildResult& InResult);
+
+  /* Run every stage for the Tile at coords */
+  void Build(int tileID, int coordX, int coordY);
+
+  /* Initialize all the Mesh values to DEFAULT value */
+  void InitMeshToCreate();
+
+  /* Generate the Vertices on the Mesh with Algorithm result */
+  void GenerateVertices();
+
+  /* Copy the HeightField to the Z of the Vertices */
+  void WriteHeights();
+
+  /* Normals and Tangents from the noise derivatives, or from central differences of the HeightField */
+  void GenerateNormalTangents();
+
+  /* Vertex colors of the Biomes */
+  void SetupBiomes();
+
+  /* Instances of the Biome assets */
+  void SetupAssets();
+
+  /* Decimate the full resolution mesh for the other levels of detail */
+  void GenerateLODs();
+
+  /* GETTER */
+  int GetValueIndexForCoordinates(int x, int y) const;
+  FVector2D GetVerticePosition(float x, float y) const;
+  FVector2D CalculateUV(float x, float y) const;
+  float ScaleZWithHeightRange(double value) const;
+  float GetNormalizedHeight(int index) const;
+
+private:
+  const FTG_GenerationParams& Params;
+  FTG_TileBuildResult& Result;
+
+  // Full resolution mesh (Result.LODMeshes[0])
+  FRuntimeMeshBuilder* Mesh = nullptr;
+  // The mesh has a color stream
+  bool UsesColors = true;
+
+  // HeightField with one extra sample on every side (empty when seamlessNormals is off)
+  TArray<float> ApronHeightField;
+
+  // Slope of the HeightField along x and y (only with analytic normals)
+  TArray<float> SlopeX;
+  TArray<float> SlopeY;
+
+  // Random numbers of this Tile (seeded with the TileSeed)
+  FRandomStream RandomStream;
+};
@@ -0,0 +1,62 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "TG_GenerationParams.h"
+#include "RuntimeMeshBuilder.h"
+
+#include "CoreMinimal.h"
+
+struct FTG_TileBuildResult;
+
+/*
+  Binary chunk with everything a worker generates for a Tile except XY, UV and the
+  levels of detail, which are rebuilt from the grid:
+    FTG_TileChunkHeader
+    float     Heights[NumVertices]
+    uint8     Tangents[TangentBytes]   packed normal and tangent stream of the mesh
+    uint8     Colors[ColorBytes]       color stream of the mesh (0 when it has no colors)
+    uint32    NumInstances[NumBiomes]
+    float     Instances[sum of NumInstances][10]   rotation XYZW, location XYZ, scale XYZ
+*/
+struct FTG_TileChunkHeader {
+  static const uint32 ChunkMagic = 0x4B484354; // "TCHK"
+  static const uint32 ChunkVersion = 1;
+
+  uint32 Magic;
+  uint32 Version;
+  uint64 SettingsHash;
+  int32 Seed;
+  int32 TileX;
+  int32 TileY;
+  uint32 NumVertices;
+  uint32 TangentBytes;
+  uint32 ColorBytes;
+  uint32 NumBiomes;
+};
+
+/*
+  On-disk cache of the generated Tiles, one file per Tile in
+  Saved/TerrainCache/<Seed>_<SettingsHash>/<x>_<y>.tile
+  Changing any setting that affects the Tiles changes the SettingsHash, so old files are never read.
+  Load and Save can run on any thread.
+*/
+class TERRAINGENERATOR_API FTG_TileCache
+{
+public:
+  /* Folder of the Tiles of these settings */
+  static FString GetCacheDir(const FTG_GenerationParams& params);
+  static FString GetTilePath(const FTG_GenerationParams& params, int x, int y);
+
+  /* Fill the heights, normals, colors and assets of the Tile from its file (false if missing or stale) */
+  static bool Load(const FTG_GenerationParams& params, int x, int y, FRuntimeMeshBuilder& mesh, FTG_TileBuildResult& result);
+
+  /* Write the Tile to its file, replacing the previous one */
+  static bool Save(const FTG_GenerationParams& params, FRuntimeMeshBuilder& mesh, const FTG_TileBuildResult& result);
+
+  /* Serialize a Tile to a chunk */
+  static void WriteChunk(const FTG_GenerationParams& params, FRuntimeMeshBuilder& mesh, const FTG_TileBuildResult& result, TArray<uint8>& out);
+
+  /* Read a chunk written with these settings for the Tile at x, y (false if it does not match) */
+  static bool ReadChunk(const FTG_GenerationParams& params, int x, int y, const uint8* data, int64 size, FRuntimeMeshBuilder& mesh, FTG_TileBuildResult& result);
+};
@@ -0,0 +1,96 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+  Compile time switches of the Tile event log:
+    TG_TILE_EVENT_LOG        1 to record events (default: every build but Shipping)
+    TG_TILE_EVENT_VERBOSITY  1 lifecycle (create, commit, evict...), 2 also every build stage
+  With the log off the macros compile to nothing.
+*/
+#ifndef TG_TILE_EVENT_LOG
+#define TG_TILE_EVENT_LOG !UE_BUILD_SHIPPING
+#endif
+
+#ifndef TG_TILE_EVENT_VERBOSITY
+#define TG_TILE_EVENT_VERBOSITY 1
+#endif
+
+enum class ETG_TileEvent : uint8 {
+  /* Lifecycle */
+  Create,
+  LoadedFromPack,
+  LoadedFromCache,
+  Commit,
+  Evict,
+  Release,
+
+  /* Stages */
+  InitMesh,
+  Vertices,
+  Biomes,
+  Assets,
+  LODs,
+  CommitMesh,
+  CommitWater,
+  CommitAssets,
+
+  Count
+};
+
+/* One event, fixed size so the log never allocates */
+struct FTG_TileEventRecord {
+  uint64 Cycles;
+  int32 TileID;
+  int32 TileX;
+  int32 TileY;
+  uint32 Arg;
+  uint32 ThreadId;
+  uint8 Event;
+  uint8 Padding[3];
+};
+
+/*
+  One ring buffer, shared by all the threads, with the last Capacity Tile events.
+  Recording is an atomic increment of a 64-bit counter (it never wraps) and a copy,
+  no lock and no formatting.
+  tg.TileEvents.Dump prints the buffer, tg.TileEvents.Dump <file> writes it as binary records.
+  tg.TileEvents.SampleEvery N only records the Tiles whose coords hash is a multiple of N.
+*/
+class TERRAINGENERATOR_API FTG_TileEventLog
+{
+public:
+  static const int32 Capacity = 8192;
+  static_assert((Capacity & (Capacity - 1)) == 0, "The Capacity is a power of two");
+
+  static FTG_TileEventLog& Get();
+
+  void Record(ETG_TileEvent event, int32 tileID, int32 tileX, int32 tileY, uint32 arg = 0);
+
+  /* Events still in the buffer, oldest first (records written meanwhile can be torn) */
+  void Snapshot(TArray<FTG_TileEventRecord>& out) const;
+
+  void DumpToLog() const;
+  bool DumpToFile(const FString& path) const;
+
+  static const TCHAR* GetEventName(ETG_TileEvent event);
+
+private:
+  // Events recorded so far, the slot of an event is its number masked with Capacity - 1
+  volatile int64 Next = 0;
+  FTG_TileEventRecord Records[Capacity];
+};
+
+#if TG_TILE_EVENT_LOG
+#define TG_TILE_EVENT(Event, TileID, X, Y, Arg) FTG_TileEventLog::Get().Record(ETG_TileEvent::Event, TileID, X, Y, Arg)
+#else
+#define TG_TILE_EVENT(Event, TileID, X, Y, Arg)
+#endif
+
+#if TG_TILE_EVENT_LOG && TG_TILE_EVENT_VERBOSITY >= 2
+#define TG_TILE_STAGE_EVENT(Event, TileID, X, Y, Arg) FTG_TileEventLog::Get().Record(ETG_TileEvent::Event, TileID, X, Y, Arg)
+#else
+#define TG_TILE_STAGE_EVENT(Event, TileID, X, Y, Arg)
+#endif
@@ -0,0 +1,46 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "RuntimeMeshBuilder.h"
+
+#include "CoreMinimal.h"
+
+/*
+  How many levels coarser the neighbour of every edge is.
+  Edges: 0 = (y = 0), 1 = (x = last), 2 = (y = last), 3 = (x = 0)
+*/
+struct FTG_LODStitch {
+  uint8 Edge[4] = { 0, 0, 0, 0 };
+
+  bool operator==(const FTG_LODStitch& other) const {
+    return FMemory::Memcmp(Edge, other.Edge, sizeof(Edge)) == 0;
+  }
+  bool operator!=(const FTG_LODStitch& other) const {
+    return !(*this == other);
+  }
+};
+
+/*
+  Levels of detail of a Tile, decimated from the full resolution grid.
+  Level N keeps one vertex of every 2^N (plus the last one of each line), so the
+  vertices of a coarse level are always on the finer ones. The edges next to a
+  coarser neighbour are stitched by collapsing the extra vertices on the coarse ones.
+*/
+struct TERRAINGENERATOR_API FTG_TileLOD
+{
+  // Max number of levels of a Tile
+  static const int MaxLODs = 6;
+
+  /* Vertices per line of the level */
+  static int GetLODLineSize(int lineSize, int lod);
+
+  /* Full resolution index of the vertex i of a line of the level */
+  static int GetSourceIndex(int lineSize, int lod, int i);
+
+  /* Copy the vertices of the level from the full resolution mesh (same stream layout) */
+  static void BuildVertices(FRuntimeMeshBuilder& source, int lineSize, int lod, FRuntimeMeshBuilder& out);
+
+  /* Grid triangles of a level with lodLineSize vertices per line */
+  static void BuildTriangles(int lodLineSize, const FTG_LODStitch& stitch, TArray<int32>& out);
+};
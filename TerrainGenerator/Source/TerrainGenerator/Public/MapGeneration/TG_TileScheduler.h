@@ -0,0 +1,93 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/CriticalSection.h"
+
+/* Forward Declaration */
+class ATG_Tile;
+class FQueuedThreadPool;
+
+/* Tile waiting for a worker */
+struct FTG_TileJob {
+  FVector2D coord;
+
+  // Tile to regenerate, nullptr if the Tile still has to be spawned
+  ATG_Tile* tile = nullptr;
+};
+
+/* Tile built by a worker, waiting to be applied on the game thread */
+struct FTG_TileCompletion {
+  FVector2D coord;
+
+  // Applies the whole Tile at once
+  TFunction<void()> commit;
+};
+
+/*
+  Fixed pool of worker threads for the Tile generation.
+  Jobs wait in a queue owned by the game thread, Update admits the nearest ones
+  while there are free workers and drops the ones that left the view range.
+  The finished jobs come back through Complete and are applied by Commit,
+  nearest first and within a time budget, so a burst of Tiles is spread over several frames.
+*/
+class TERRAINGENERATOR_API FTG_TileScheduler
+{
+public:
+  FTG_TileScheduler();
+  ~FTG_TileScheduler();
+
+  /* Create the workers (numWorkers <= 0 uses the number of cores - 1) */
+  void Start(int numWorkers);
+
+  /* Drop the queued jobs and wait for the running ones */
+  void Stop();
+
+  /* Queue a Tile (ignored if this coord is already waiting) */
+  void Enqueue(FVector2D coord, ATG_Tile* tile = nullptr);
+
+  /* Drop the queued job of this coord (if any) */
+  void Cancel(FVector2D coord);
+
+  /* Cancel the jobs farther than cancelRange tiles from center (cancelRange < 0 keeps them)
+     and move the nearest ones to admitted, up to the free workers and maxAdmissions */
+  void Update(FVector2D center, int cancelRange, int maxAdmissions, TArray<FTG_TileJob>& admitted);
+
+  /* Run an admitted job on a worker */
+  void Launch(TFunction<void()> work);
+
+  /* Hand a finished Tile to the game thread (any thread) */
+  void Complete(FVector2D coord, TFunction<void()> commit);
+
+  /* Apply the finished Tiles nearest to center until budgetSeconds is spent (game thread).
+     At least one Tile is applied per call, budgetSeconds <= 0 applies all of them.
+     Returns the number of Tiles applied. */
+  int Commit(FVector2D center, double budgetSeconds);
+
+  bool IsQueued(FVector2D coord) const;
+  int NumQueued() const { return Queue.Num(); }
+  int NumInFlight() const { return InFlight.GetValue(); }
+  int NumWorkers() const { return Workers; }
+  int NumPendingCommits() const { return Pending.Num() + NumCompleted.GetValue(); }
+
+private:
+  FQueuedThreadPool* Pool = nullptr;
+  int Workers = 0;
+
+  // Jobs not started yet (game thread only)
+  TArray<FTG_TileJob> Queue;
+  TSet<FVector2D> QueuedCoords;
+
+  // Jobs running on the workers
+  FThreadSafeCounter InFlight;
+
+  // Finished by the workers, not seen by the game thread yet
+  FCriticalSection CompletedLock;
+  TArray<FTG_TileCompletion> Completed;
+  FThreadSafeCounter NumCompleted;
+
+  // Finished and waiting for commit budget (game thread only)
+  TArray<FTG_TileCompletion> Pending;
+};
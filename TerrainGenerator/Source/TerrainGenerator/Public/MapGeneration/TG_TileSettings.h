@@ -11,6 +11,14 @@ enum class TerrainSizeIn : uint8 {
   TerrainSizeIn_KM  UMETA(DisplayName = "Kilometers"),
 };
 
+UENUM(BlueprintType)
+enum class TileVertexFormat : uint8 {
+  // Float UVs, vertex colors and 32-bit indices
+  TileVertexFormat_Full     UMETA(DisplayName = "Full"),
+  // Half UVs, no vertex colors when they are not used and 16-bit indices when they fit
+  TileVertexFormat_Compact  UMETA(DisplayName = "Compact"),
+};
+
 USTRUCT(BlueprintType)
 struct FTileSettings {
   GENERATED_BODY()
@@ -26,6 +34,13 @@ struct FTileSettings {
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TileSettings")
     TerrainSizeIn LODScale = TerrainSizeIn::TerrainSizeIn_CM;
 
+  /* Levels of detail by distance, every level halves the vertices per line */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TileSettings", meta = (ClampMin = "1", ClampMax = "6", UIMin = "1", UIMax = "6"))
+    int NumLODs = 3;
+  /* Distance between levels of detail, beyond the Tiles next to the player (0 = TileSize) */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TileSettings", meta = (ClampMin = "0.0"))
+    float LODDistance = 0.f;
+
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TileSettings", meta = (ClampMin = "1.0"))
     float HeightRange = 25000.0f;
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TileSettings")
@@ -53,27 +68,32 @@ struct FTileSettings {
   }
 
   /* Get the ArrayLineSize value */
-  int getArrayLineSize() {
+  int getArrayLineSize() const {
     return ArrayLineSize;
   }
 
   /* Get the tileSize with the correct measure */
-  float getTileSize() {
+  float getTileSize() const {
     return TileSize * getTerrainScaleValue(TileScaleIn);
   }
 
   /* Get the tessellation number with the correct measure */
-  float getLOD() {
+  float getLOD() const {
     return LevelOfDetail * getTerrainScaleValue(LODScale);
   }
 
+  /* Get the distance between levels of detail with the correct measure */
+  float getLODDistance() const {
+    return LODDistance > 0.f ? LODDistance * getTerrainScaleValue(TileScaleIn) : getTileSize();
+  }
+
   /* Get the tessellation number with the correct measure */
-  float getHeightRange() {
+  float getHeightRange() const {
     return HeightRange * getTerrainScaleValue(HeightScale);
   }
 
   /* Calculate the correct measure */
-  int getTerrainScaleValue(TerrainSizeIn measure) {
+  int getTerrainScaleValue(TerrainSizeIn measure) const {
     switch (measure)
     {
     case TerrainSizeIn::TerrainSizeIn_CM:
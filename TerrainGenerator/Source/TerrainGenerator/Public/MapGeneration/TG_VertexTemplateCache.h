@@ -0,0 +1,49 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+/* XY position (Z = 0) and UV of every vertex of a grid, equal for all the Tiles */
+struct FTG_VertexTemplate {
+  TArray<FVector> Positions;
+  TArray<FVector2D> UV;
+  TArray<FVector2DHalf> UVHalf;
+};
+
+typedef TSharedPtr<const FTG_VertexTemplate, ESPMode::ThreadSafe> FTG_VertexTemplatePtr;
+
+/*
+  Process-wide cache of the vertex templates, keyed by vertices per line, vertex spacing
+  and texture scale. A Tile copies the template and only writes the heights.
+  Like FTG_IndexBufferCache it keeps every template until Reset (new generation settings).
+*/
+class TERRAINGENERATOR_API FTG_VertexTemplateCache
+{
+public:
+  static FTG_VertexTemplateCache& Get();
+
+  /* Template of a grid (built the first time, any thread) */
+  FTG_VertexTemplatePtr FindOrBuild(int lineSize, float spacing, float textureScale);
+
+  /* Drop every template, the ones still referenced stay alive until released */
+  void Reset();
+
+private:
+  struct FKey {
+    int LineSize;
+    float Spacing;
+    float TextureScale;
+
+    bool operator==(const FKey& other) const {
+      return LineSize == other.LineSize && Spacing == other.Spacing && TextureScale == other.TextureScale;
+    }
+    friend uint32 GetTypeHash(const FKey& key) {
+      return HashCombine(HashCombine(::GetTypeHash(key.LineSize), ::GetTypeHash(key.Spacing)), ::GetTypeHash(key.TextureScale));
+    }
+  };
+
+  FCriticalSection Lock;
+  TMap<FKey, FTG_VertexTemplatePtr> Templates;
+};
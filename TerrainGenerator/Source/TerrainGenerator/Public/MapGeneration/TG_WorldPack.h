@@ -0,0 +1,112 @@
+// Procedural Terrain Generator by Oriol Marc Clariana Justes 2018 (https://oriolclariana.com)
+
+#pragma once
+
+#include "TG_GenerationParams.h"
+#include "RuntimeMeshBuilder.h"
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+struct FTG_TileBuildResult;
+class IMappedFileHandle;
+class IMappedFileRegion;
+class IFileHandle;
+
+/*
+  World Pack file, every Tile of a baked world in one file:
+    FTG_WorldPackHeader
+    FTG_WorldPackEntry   Index[NumTiles]
+    Tile chunks (see FTG_TileChunkHeader), each one starting on a ChunkAlignment boundary
+  so a Tile only touches its own pages when the file is mapped.
+*/
+struct FTG_WorldPackHeader {
+  static const uint32 PackMagic = 0x4B505754; // "TWPK"
+  static const uint32 PackVersion = 1;
+  static const uint32 ChunkAlignment = 4096;
+
+  uint32 Magic;
+  uint32 Version;
+  uint64 SettingsHash;
+  int32 Seed;
+  uint32 NumTiles;
+  uint64 IndexOffset;
+};
+
+struct FTG_WorldPackEntry {
+  int32 TileX;
+  int32 TileY;
+  uint64 Offset;
+  uint64 Size;
+};
+
+/*
+  Writes a World Pack, the chunks are appended as they are added (from any thread)
+  and the index is written on Close.
+*/
+class TERRAINGENERATOR_API FTG_WorldPackWriter
+{
+public:
+  ~FTG_WorldPackWriter();
+
+  /* Start a World Pack for up to maxTiles Tiles built with these settings */
+  bool Open(const FString& path, const FTG_GenerationParams& params, int maxTiles);
+
+  /* Append the chunk of a Tile (see FTG_TileCache::WriteChunk) */
+  bool AddTile(int x, int y, const TArray<uint8>& chunk);
+
+  /* Write the index and replace the previous file */
+  bool Close();
+
+  int NumTiles() const { return Entries.Num(); }
+
+private:
+  FCriticalSection Lock;
+  TUniquePtr<FArchive> Writer;
+  FString Path;
+  FString TempPath;
+  FTG_WorldPackHeader Header;
+  TArray<FTG_WorldPackEntry> Entries;
+  int MaxTiles = 0;
+  int64 Cursor = 0;
+};
+
+/*
+  Baked World Pack opened for streaming. The file is mapped once and the OS pages
+  the chunks in when a Tile is read; without mapping the chunks are read from a handle.
+  Load can run on any thread.
+*/
+class TERRAINGENERATOR_API FTG_WorldPack
+{
+public:
+  ~FTG_WorldPack();
+
+  /* Open a World Pack (null if missing or invalid) */
+  static TSharedPtr<FTG_WorldPack, ESPMode::ThreadSafe> Open(const FString& path);
+
+  uint64 GetSettingsHash() const { return Header.SettingsHash; }
+  int32 GetSeed() const { return Header.Seed; }
+  int NumTiles() const { return Index.Num(); }
+  const FString& GetPath() const { return Path; }
+
+  /* The pack has the Tile at x, y */
+  bool Contains(int x, int y) const;
+
+  /* Fill the heights, normals, colors and assets of the Tile from the pack (false if missing or stale) */
+  bool Load(const FTG_GenerationParams& params, int x, int y, FRuntimeMeshBuilder& mesh, FTG_TileBuildResult& result) const;
+
+private:
+  FString Path;
+  FTG_WorldPackHeader Header;
+  TMap<FIntPoint, FTG_WorldPackEntry> Index;
+
+  // The region is released before the handle
+  TUniquePtr<IMappedFileHandle> MappedFile;
+  TUniquePtr<IMappedFileRegion> MappedRegion;
+
+  // Fallback when the platform can not map files
+  TUniquePtr<IFileHandle> File;
+  mutable FCriticalSection FileLock;
+};
+
+typedef TSharedPtr<const FTG_WorldPack, ESPMode::ThreadSafe> FTG_WorldPackPtr;